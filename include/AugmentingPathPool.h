@@ -0,0 +1,168 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_AUGMENTINGPATHPOOL_H
+#define DA_WATERSUPPLYMANAGEMENT_AUGMENTINGPATHPOOL_H
+
+#include <vector>
+#include <cstdint>
+#include "Pipe.h"
+
+class Pipe;
+
+/**
+ * @brief Class that stores the augmenting paths of a flow decomposition in flat, pooled arrays
+ * @details Every path is stored in one contiguous array of arcs, where each arc packs the index of the pipe and a bit
+ * indicating if the pipe is direct or reversed in the path. The paths are delimited by an array of offsets. After all
+ * the paths are added, an index from each pipe to the paths that pass through it (or through its reverse pipe) is built
+ * in compressed sparse row format.
+ */
+class AugmentingPathPool {
+public:
+    /**
+     * @brief Constructor of the AugmentingPathPool class
+     */
+    AugmentingPathPool();
+
+    /**
+     * @brief Removes all the augmenting paths and the pipe index
+     * @details Complexity: O(1) amortized.
+     */
+    void clear();
+
+    /**
+     * @brief Adds an augmenting path to the pool
+     * @details The pipes must have been indexed beforehand. Complexity: O(n), where n is the number of pipes in the path.
+     * @param pipes Vector with the pairs of pipes and booleans (indicating the direction) in the augmenting path
+     * @param capacity Capacity (flow) of the augmenting path
+     * @return Index of the newly added augmenting path
+     */
+    int addPath(const std::vector<std::pair<Pipe *, bool>> &pipes, double capacity);
+
+    /**
+     * @brief Normalizes the decomposition into a canonical form
+     * @details The paths are sorted by their sequence of arcs, paths with the same sequence are merged into one (adding
+     * their capacities) and paths without capacity are removed. The pipe index must be built afterwards.
+     * Complexity: O(A*log(n)), where A is the total number of arcs in the paths and n the number of paths.
+     */
+    void normalize();
+
+    /**
+     * @brief Builds the index from each pipe to the augmenting paths that pass through it or through its reverse
+     * @details Complexity: O(P+A), where P is the number of pipes and A the total number of arcs in the paths.
+     * @param pipes Vector with all the pipes in the network, ordered by their index
+     */
+    void buildPipeIndex(const std::vector<Pipe *> &pipes);
+
+    /**
+     * @brief Returns the number of augmenting paths in the pool
+     * @return Number of augmenting paths
+     */
+    int getNumPaths() const;
+
+    /**
+     * @brief Returns the position of the first arc of an augmenting path
+     * @param path Index of the augmenting path
+     * @return Position of the first arc of the path
+     */
+    uint32_t getPathBegin(int path) const;
+
+    /**
+     * @brief Returns the position after the last arc of an augmenting path
+     * @param path Index of the augmenting path
+     * @return Position after the last arc of the path
+     */
+    uint32_t getPathEnd(int path) const;
+
+    /**
+     * @brief Returns the index of the pipe of an arc
+     * @param arc Position of the arc
+     * @return Index of the pipe
+     */
+    int getArcPipe(uint32_t arc) const;
+
+    /**
+     * @brief Returns whether the pipe of an arc is direct or reversed in its augmenting path
+     * @param arc Position of the arc
+     * @return True if the pipe is direct in the path, false if it is reversed
+     */
+    bool isArcDirect(uint32_t arc) const;
+
+    /**
+     * @brief Returns the capacity of an augmenting path
+     * @param path Index of the augmenting path
+     * @return Capacity (flow) of the augmenting path
+     */
+    double getCapacity(int path) const;
+
+    /**
+     * @brief Returns the first position in the pipe index of the paths that pass through a pipe
+     * @param pipe Index of the pipe
+     * @return Iterator to the first path that passes through the pipe
+     */
+    std::vector<uint32_t>::const_iterator getPipePathsBegin(int pipe) const;
+
+    /**
+     * @brief Returns the position after the last in the pipe index of the paths that pass through a pipe
+     * @param pipe Index of the pipe
+     * @return Iterator after the last path that passes through the pipe
+     */
+    std::vector<uint32_t>::const_iterator getPipePathsEnd(int pipe) const;
+
+    /**
+     * @brief Checks if an augmenting path is selected
+     * @param path Index of the augmenting path
+     * @return True if the path is selected, false otherwise
+     */
+    bool isSelected(int path) const;
+
+    /**
+     * @brief Selects an augmenting path, adding it to the list of selected paths if it was not selected before
+     * @details Complexity: O(1) amortized.
+     * @param path Index of the augmenting path
+     * @return True if the path was newly selected, false if it was already selected
+     */
+    bool select(int path);
+
+    /**
+     * @brief Selects all the augmenting paths that pass through a pipe
+     * @details Complexity: O(n), where n is the number of augmenting paths that pass through the pipe.
+     * @param pipe Index of the pipe
+     */
+    void selectPipePaths(int pipe);
+
+    /**
+     * @brief Returns the number of selected augmenting paths
+     * @return Number of selected augmenting paths
+     */
+    int getNumSelected() const;
+
+    /**
+     * @brief Returns one of the selected augmenting paths, in the order they were selected
+     * @param i Position in the list of selected paths
+     * @return Index of the augmenting path
+     */
+    int getSelected(int i) const;
+
+    /**
+     * @brief Unselects all the selected augmenting paths
+     * @details Complexity: O(n), where n is the number of selected augmenting paths.
+     */
+    void unselectAll();
+
+    /**
+     * @brief Discards the selected augmenting paths, setting their capacities to zero, and unselects them
+     * @details The paths are only removed from the pool by the next normalization. Complexity: O(n), where n is the
+     * number of selected augmenting paths.
+     */
+    void discardSelected();
+
+private:
+    std::vector<uint32_t> arcs;
+    std::vector<uint32_t> pathOffsets;
+    std::vector<double> capacities;
+    std::vector<bool> selected;
+    std::vector<int> selection;
+
+    std::vector<uint32_t> pipePathOffsets;
+    std::vector<uint32_t> pipePaths;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_AUGMENTINGPATHPOOL_H
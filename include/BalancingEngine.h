@@ -0,0 +1,148 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_BALANCINGENGINE_H
+#define DA_WATERSUPPLYMANAGEMENT_BALANCINGENGINE_H
+
+#include <vector>
+#include <tuple>
+#include <functional>
+#include "FlowGraph.h"
+#include "MetricsAccumulator.h"
+
+/**
+ * @brief State of a balancing, reported after each phase
+ */
+struct BalanceProgress {
+    int cyclesCancelled;
+    double step;
+    double elapsedSeconds;
+    std::tuple<double, double, double> metrics;
+};
+
+/**
+ * @brief Class that balances a max flow, minimizing the variance of the differences between capacity and flow
+ * @details The differences are the ones reported by WaterSupplyNetwork::getMetrics: one for each pipe (both directions
+ * of a bidirectional pipe together), without the pipes of the super source and super sink and the excluded arcs (the
+ * pipes of the pumping stations to their outlets), which can still carry the cycles. The flow is changed only
+ * along cycles of the residual graph, so the total flow (and therefore the max flow) is kept. Each phase pushes a fixed
+ * step of flow along negative cycles, found with the Bellman-Ford algorithm, where the cost of moving the step through
+ * a pipe is the change of its squared distance to the mean difference. The costs of the moves are estimated one by one,
+ * so a cycle that crosses a pipe twice or shifts the mean may not reduce the variance (or may overflow a pipe), and each
+ * cycle is undone if it did not strictly reduce the variance within the capacities. When there are no more such cycles
+ * the step is halved, until it is smaller than the minimum step or the time budget runs out, so the balancing always
+ * ends. Since the steps are powers of two, integer flows stay integer.
+ */
+class BalancingEngine {
+public:
+    /**
+     * @brief Constructor of the BalancingEngine class
+     * @param graph Graph of the network
+     * @param flows Vector with a max flow, indexed by arc, that will be balanced in place
+     * @param excludedArcs Vector that marks the arcs whose differences are not balanced, indexed by arc
+     */
+    BalancingEngine(const FlowGraph &graph, std::vector<double> &flows, const std::vector<char> &excludedArcs);
+
+    /**
+     * @brief Sets the maximum time that the balancing can take
+     * @param seconds Time budget in seconds (0 or less for no limit)
+     */
+    void setTimeBudget(double seconds);
+
+    /**
+     * @brief Sets the smallest step of flow to push along a cycle
+     * @param step Minimum step
+     */
+    void setMinStep(double step);
+
+    /**
+     * @brief Sets a function that is called with the progress of the balancing, at the start and after each phase
+     * @param callback Function to call
+     */
+    void setProgressCallback(const std::function<void(const BalanceProgress &)> &callback);
+
+    /**
+     * @brief Balances the flow
+     * @details Complexity: O(C*V*E), where C is the number of cycles cancelled, V the number of vertices and E the
+     * number of arcs in the graph.
+     * @return Final state of the balancing
+     */
+    BalanceProgress run();
+
+    /**
+     * @brief Returns the metrics of the current flow
+     * @details The differences are kept in an accumulator that is updated only for the pipes of each cycle cancelled.
+     * Complexity: O(1), or O(E) if the maximum difference was decreased, where E is the number of arcs in the graph.
+     * @return Tuple with the maximum, the mean and the variance of the differences between capacity and flow
+     */
+    std::tuple<double, double, double> getMetrics() const;
+
+private:
+    /**
+     * @brief Move of the step of flow through an arc, in one of the directions
+     */
+    struct Move {
+        int from;
+        int to;
+        int arc;
+        bool direct;
+        double cost;
+    };
+
+    /**
+     * @brief Returns the difference between capacity and flow of a pipe
+     * @param pipe Index of the pipe
+     * @return Difference between capacity and flow
+     */
+    double getSlack(int pipe) const;
+
+    /**
+     * @brief Returns the difference between capacity and flow of a pipe, after moving some flow through one of its arcs
+     * @param arc Index of the arc
+     * @param value Flow added to the arc (negative to remove)
+     * @return Difference between capacity and flow after the move
+     */
+    double getSlackAfter(int arc, double value) const;
+
+    /**
+     * @brief Recalculates the accumulator of the differences from the flows, discarding rounding errors
+     */
+    void resetSlacks();
+
+    /**
+     * @brief Builds the moves of the residual graph that can take the step of flow, with their costs
+     * @param step Step of flow
+     * @param mean Current mean of the differences
+     */
+    void buildMoves(double step, double mean);
+
+    /**
+     * @brief Finds a cycle with negative cost among the moves, using the Bellman-Ford algorithm
+     * @param cycle Vector that will hold the indexes of the moves of the cycle
+     * @return True if a cycle was found, false otherwise
+     */
+    bool findNegativeCycle(std::vector<int> &cycle);
+
+    /**
+     * @brief Pushes a value of flow along a cycle of moves, updating the differences of its pipes
+     * @details Complexity: O(n), where n is the number of moves in the cycle.
+     * @param cycle Vector with the indexes of the moves of the cycle
+     * @param value Value of flow to push (negative to undo a push)
+     * @return True if every arc of the cycle is within its capacity afterwards, false otherwise
+     */
+    bool pushCycle(const std::vector<int> &cycle, double value);
+
+    const FlowGraph &graph;
+    std::vector<double> &flows;
+    std::vector<int> pipeArcs;
+    std::vector<int> arcPipes;
+    MetricsAccumulator slacks;
+
+    double timeBudget;
+    double minStep;
+    std::function<void(const BalanceProgress &)> progressCallback;
+
+    std::vector<Move> moves;
+    std::vector<double> remaining;
+    std::vector<double> distances;
+    std::vector<int> parentMoves;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_BALANCINGENGINE_H
@@ -33,7 +33,8 @@ public:
 
     /**
      * @brief Returns the supply rate of the delivery site
-     * @details Complexity: O(n) where n is the number of incoming edges.
+     * @details The supply rate is the total flow of the incoming pipes, which is kept as the flows change.
+     * Complexity: O(1).
      * @return Supply rate of the delivery site in m^3/sec
      */
     double getSupplyRate() const;
@@ -97,7 +97,7 @@ private:
 };
 
 template <class T>
-Edge<T>::Edge(Vertex<T> *orig, Vertex<T> *dest, double weight) : orig(orig), dest(dest), weight(weight), reverse(nullptr) {}
+Edge<T>::Edge(Vertex<T> *orig, Vertex<T> *dest, double weight) : orig(orig), dest(dest), weight(weight), flow(0), selected(false), reverse(nullptr) {}
 
 template<class T>
 Edge<T>::~Edge() = default;
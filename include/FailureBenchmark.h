@@ -0,0 +1,92 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_FAILUREBENCHMARK_H
+#define DA_WATERSUPPLYMANAGEMENT_FAILUREBENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "WaterSupplyNetwork.h"
+
+/**
+ * @brief Failure of one element, evaluated by the incremental and the brute-force algorithms
+ * @details The times are the best of the repetitions, in seconds, and the case diverges when the two max flows differ by
+ * more than the tolerance of WaterSupplyNetwork::getFlowTolerance.
+ */
+struct BenchmarkCase {
+    std::string kind;
+    std::string description;
+    double incrementalFlow;
+    double bruteForceFlow;
+    double incrementalTime;
+    double bruteForceTime;
+    bool diverges;
+};
+
+/**
+ * @brief Summary of the cases of one kind of element
+ * @details The times are the sums of the times of the cases, and the speedups are the percentiles of the speedups of the
+ * cases (brute-force time over incremental time).
+ */
+struct BenchmarkSummary {
+    std::string kind;
+    size_t numCases;
+    size_t numDivergent;
+    double incrementalTime;
+    double bruteForceTime;
+    double medianSpeedup;
+    double p99Speedup;
+};
+
+/**
+ * @brief Class that compares the incremental failure analysis of a network with the brute-force one
+ * @details The failure of every pipe (a bidirectional pipe counts once), reservoir and pumping station is evaluated with
+ * getMaxFlowWithoutPipes, getMaxFlowWithoutReservoir and getMaxFlowWithoutStation, and with their brute-force
+ * counterparts. Both max flows are kept to flag the cases in which they diverge, and both times to measure the speedup
+ * (brute-force time over incremental time) of each case. Each algorithm is timed a few times and the best time is
+ * kept, since the evaluations of small networks take only microseconds and are easily disturbed.
+ */
+class FailureBenchmark {
+public:
+    /**
+     * @brief Constructor of the FailureBenchmark class
+     * @param wsn Network to evaluate, whose hidden service points and pipes are restored after each evaluation
+     */
+    explicit FailureBenchmark(WaterSupplyNetwork &wsn);
+
+    /**
+     * @brief Evaluates the failure of every element with both algorithms, replacing the previous cases
+     * @details Complexity: O(r*n*V*E^2), where r is the number of repetitions, n the number of elements, V the number of
+     * vertices and E the number of edges.
+     * @param repetitions Number of times each algorithm is run for each element
+     */
+    void run(unsigned repetitions = 3);
+
+    /**
+     * @brief Returns the cases evaluated by the last run
+     * @return Constant reference to the vector with the cases, in the order of WaterSupplyNetwork::forEachFailureElement
+     */
+    const std::vector<BenchmarkCase> &getCases() const;
+
+    /**
+     * @brief Summarizes the cases of each kind of element, including the percentiles of their speedups
+     * @details Complexity: O(n*log(n)), where n is the number of cases.
+     * @return Vector with one summary for each kind of element that has cases
+     */
+    std::vector<BenchmarkSummary> getSummaries() const;
+
+private:
+    /**
+     * @brief Evaluates the failure of one element with both algorithms and adds it to the cases
+     * @param kind Kind of the element
+     * @param description Description of the element
+     * @param incremental Function that returns the max flow without the element, found by the incremental algorithm
+     * @param bruteForce Function that returns the max flow without the element, found by the brute-force algorithm
+     * @param repetitions Number of times each algorithm is run
+     */
+    void addCase(const std::string &kind, const std::string &description, const std::function<double()> &incremental,
+                 const std::function<double()> &bruteForce, unsigned repetitions);
+
+    WaterSupplyNetwork &wsn;
+    std::vector<BenchmarkCase> cases;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_FAILUREBENCHMARK_H
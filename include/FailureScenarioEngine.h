@@ -0,0 +1,130 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_FAILURESCENARIOENGINE_H
+#define DA_WATERSUPPLYMANAGEMENT_FAILURESCENARIOENGINE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "FlowGraph.h"
+#include "FlowSolver.h"
+#include "AugmentingPathPool.h"
+#include "DeliverySite.h"
+#include "ScenarioResultStore.h"
+
+/**
+ * @brief Element of the network that can fail (pipe, pumping station or reservoir)
+ * @details An element with a capacity factor above zero does not fail completely: its arcs keep that fraction of their
+ * capacities (like a reservoir in a drought).
+ */
+struct FailureElement {
+    std::string description;
+    std::vector<int> arcs;
+    double capacityFactor;
+};
+
+/**
+ * @brief Worst combination of failures found for one city
+ */
+struct CityFailureReport {
+    DeliverySite *city;
+    int vertex;
+    double normalSupply;
+    double worstSupply;
+    std::vector<std::string> failures;
+};
+
+/**
+ * @brief Result of an analysis of combinations of failures
+ */
+struct FailureReport {
+    int k;
+    double normalFlow;
+    double worstFlow;
+    std::vector<std::string> worstFlowFailures;
+    std::vector<CityFailureReport> cities;
+    uint64_t numCombinations;
+    uint64_t numPruned;
+    uint64_t numEvaluated;
+};
+
+/**
+ * @brief Class that finds the worst combinations of up to k simultaneous failures (N-k analysis)
+ * @details Each combination is evaluated by repairing the baseline max flow: the augmenting paths of the baseline
+ * decomposition that pass through the failed elements are subtracted and the flow is augmented again. A combination C is
+ * pruned when one of its elements e carries no flow in the (repaired) flow of C without e, since that flow remains a max
+ * flow without e. For k = 1 this skips the elements that carry no flow in the baseline. Pruning is exact for the total
+ * flow: the flow of the smaller combination that dominates a pruned one is also a max flow of the pruned one. The
+ * remaining combinations of each size are evaluated in parallel by a TaskScheduler, each worker with its own FlowSolver.
+ * Since a max flow does not fix how the water is split between the cities, the supply of each city is the one of the
+ * flow kept for each combination (for a pruned one, the flow of the combination that dominates it, which may differ
+ * from its own repair), so the worst supplies of the cities are the worst of those flows, not a bound.
+ */
+class FailureScenarioEngine {
+public:
+    /**
+     * @brief Constructor of the FailureScenarioEngine class
+     * @param graph Graph of the network
+     * @param baselineFlows Max flow of the network without failures, indexed by arc
+     * @param baselinePaths Decomposition of the baseline max flow in augmenting paths
+     */
+    FailureScenarioEngine(const FlowGraph &graph, const std::vector<double> &baselineFlows,
+                          const AugmentingPathPool &baselinePaths);
+
+    /**
+     * @brief Adds an element that can fail
+     * @details The twins of the arcs (see FlowGraph::getTwin) are added to the element when it removes them.
+     * @param description Description of the element, used in the reports
+     * @param arcs Vector with the indexes of the arcs that fail with the element
+     * @param capacityFactor Fraction of the capacities that the arcs keep when the element fails (0 to remove them)
+     */
+    void addElement(const std::string &description, const std::vector<int> &arcs, double capacityFactor = 0);
+
+    /**
+     * @brief Returns the elements that can fail
+     * @return Constant reference to the vector of elements
+     */
+    const std::vector<FailureElement> &getElements() const;
+
+    /**
+     * @brief Analyses all the combinations of up to k failed elements and finds the worst ones for each city
+     * @details Complexity: O(C(n,k)*k + S*V*E^2), where n is the number of elements, S the number of combinations that
+     * are not pruned, V the number of vertices and E the number of arcs in the graph.
+     * @param k Maximum number of simultaneous failures
+     * @param cities Vector with the indexes of the vertices of the cities
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     * @return Report with the worst combinations, for the whole network and for each city
+     */
+    FailureReport analyse(int k, const std::vector<int> &cities, unsigned numThreads = 0) const;
+
+    /**
+     * @brief Evaluates the failure of each element alone and appends the supply of the cities in each one to a store
+     * @details The elements that carry no flow in the baseline are not evaluated, since the flows do not change. The
+     * scenarios are appended in the order of the elements, whatever the number of threads. Complexity: O(n*V*E^2),
+     * where n is the number of elements, V the number of vertices and E the number of arcs in the graph.
+     * @param cities Vector with the indexes of the vertices of the cities, in the order of the columns of the store
+     * @param store Store to which the scenarios are appended
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     */
+    void sweep(const std::vector<int> &cities, ScenarioResultStore &store, unsigned numThreads = 0) const;
+
+private:
+    /**
+     * @brief Evaluates one combination of failures, repairing the baseline flow
+     * @param solver Solver of the thread
+     * @param combination Vector with the indexes of the failed elements
+     */
+    void evaluate(FlowSolver &solver, const std::vector<int> &combination) const;
+
+    /**
+     * @brief Computes which elements carry flow
+     * @param flows Vector with the flows, indexed by arc
+     * @param activity Bitset (with one bit per element) that will hold the result
+     */
+    void computeActivity(const std::vector<double> &flows, uint64_t *activity) const;
+
+    const FlowGraph &graph;
+    const std::vector<double> &baselineFlows;
+    const AugmentingPathPool &baselinePaths;
+    std::vector<FailureElement> elements;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_FAILURESCENARIOENGINE_H
@@ -0,0 +1,188 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_FLOWGRAPH_H
+#define DA_WATERSUPPLYMANAGEMENT_FLOWGRAPH_H
+
+#include <vector>
+#include "ServicePoint.h"
+#include "Pipe.h"
+
+/**
+ * @brief Class that represents an immutable snapshot of a water supply network in flat arrays
+ * @details The vertices and arcs are identified by indexes, and the outgoing and incoming arcs of each vertex are stored
+ * in compressed sparse row format. Each arc corresponds to a pipe of the network (with the same index) and, like the
+ * pipes, bidirectional pipes are represented by two arcs that are the reverse of each other. The flows are not part of
+ * the snapshot, so that many solvers can share it and keep their own flows.
+ */
+class FlowGraph {
+public:
+    /**
+     * @brief Constructor of the FlowGraph class
+     */
+    FlowGraph();
+
+    /**
+     * @brief Builds the snapshot from the service points and pipes of a frozen network
+     * @details Complexity: O(V+E), where V is the number of service points and E the number of pipes.
+     * @param servicePoints Vector with the service points, ordered by their index
+     * @param pipes Vector with the pipes, ordered by their index
+     * @param source Super source of the network
+     * @param sink Super sink of the network
+     */
+    void build(const std::vector<ServicePoint *> &servicePoints, const std::vector<Pipe *> &pipes,
+               const ServicePoint *source, const ServicePoint *sink);
+
+    /**
+     * @brief Builds the snapshot from arrays with the ends, reverses and capacities of the arcs
+     * @details Used for graphs that do not come from a network, like a reduced graph (see FlowGraphReducer). The arcs of
+     * each vertex are kept in the order of their indexes. Complexity: O(V+E), where V is the number of vertices and E
+     * the number of arcs.
+     * @param numVertices Number of vertices
+     * @param source Index of the source vertex
+     * @param sink Index of the sink vertex
+     * @param tails Vector with the origin vertex of each arc
+     * @param heads Vector with the destination vertex of each arc
+     * @param reverses Vector with the reverse of each arc, or -1 for unidirectional arcs
+     * @param capacities Vector with the capacity of each arc
+     */
+    void build(int numVertices, int source, int sink, const std::vector<int> &tails, const std::vector<int> &heads,
+               const std::vector<int> &reverses, const std::vector<double> &capacities);
+
+    /**
+     * @brief Returns the number of vertices
+     * @return Number of vertices in the graph
+     */
+    int getNumVertices() const;
+
+    /**
+     * @brief Returns the number of arcs
+     * @return Number of arcs in the graph
+     */
+    int getNumArcs() const;
+
+    /**
+     * @brief Returns the index of the source vertex
+     * @return Index of the super source
+     */
+    int getSource() const;
+
+    /**
+     * @brief Returns the index of the sink vertex
+     * @return Index of the super sink
+     */
+    int getSink() const;
+
+    /**
+     * @brief Returns the origin vertex of an arc
+     * @param arc Index of the arc
+     * @return Index of the origin vertex
+     */
+    int getTail(int arc) const;
+
+    /**
+     * @brief Returns the destination vertex of an arc
+     * @param arc Index of the arc
+     * @return Index of the destination vertex
+     */
+    int getHead(int arc) const;
+
+    /**
+     * @brief Returns the reverse arc of an arc
+     * @param arc Index of the arc
+     * @return Index of the reverse arc, or -1 if the arc is unidirectional
+     */
+    int getReverse(int arc) const;
+
+    /**
+     * @brief Returns the twin arc of an arc, the other direction of a bidirectional pipe that was split in two
+     * @details See Pipe::getTwin. The graphs built from arrays have no twins.
+     * @param arc Index of the arc
+     * @return Index of the twin arc, or -1 if the arc has no twin
+     */
+    int getTwin(int arc) const;
+
+    /**
+     * @brief Returns the capacity of an arc
+     * @param arc Index of the arc
+     * @return Capacity of the arc
+     */
+    double getCapacity(int arc) const;
+
+    /**
+     * @brief Updates the capacities of the arcs from the pipes of the network, keeping the rest of the snapshot
+     * @details Complexity: O(E), where E is the number of pipes.
+     * @param pipes Vector with the pipes, ordered by their index
+     */
+    void updateCapacities(const std::vector<Pipe *> &pipes);
+
+    /**
+     * @brief Returns the capacities of all the arcs
+     * @return Constant reference to the vector of capacities, indexed by arc
+     */
+    const std::vector<double> &getCapacities() const;
+
+    /**
+     * @brief Returns the position of the first outgoing arc of a vertex
+     * @param v Index of the vertex
+     * @return Position of the first outgoing arc in the array of outgoing arcs
+     */
+    int getOutBegin(int v) const;
+
+    /**
+     * @brief Returns the position after the last outgoing arc of a vertex
+     * @param v Index of the vertex
+     * @return Position after the last outgoing arc in the array of outgoing arcs
+     */
+    int getOutEnd(int v) const;
+
+    /**
+     * @brief Returns an outgoing arc
+     * @param pos Position in the array of outgoing arcs
+     * @return Index of the arc
+     */
+    int getOutArc(int pos) const;
+
+    /**
+     * @brief Returns the position of the first incoming arc of a vertex
+     * @param v Index of the vertex
+     * @return Position of the first incoming arc in the array of incoming arcs
+     */
+    int getInBegin(int v) const;
+
+    /**
+     * @brief Returns the position after the last incoming arc of a vertex
+     * @param v Index of the vertex
+     * @return Position after the last incoming arc in the array of incoming arcs
+     */
+    int getInEnd(int v) const;
+
+    /**
+     * @brief Returns an incoming arc
+     * @param pos Position in the array of incoming arcs
+     * @return Index of the arc
+     */
+    int getInArc(int pos) const;
+
+    /**
+     * @brief Returns the total flow that enters a vertex
+     * @details Complexity: O(d), where d is the number of incoming arcs of the vertex.
+     * @param flows Vector with the flows, indexed by arc
+     * @param v Index of the vertex
+     * @return Sum of the flows of the incoming arcs
+     */
+    double getInflow(const std::vector<double> &flows, int v) const;
+
+private:
+    int source;
+    int sink;
+    std::vector<int> tails;
+    std::vector<int> heads;
+    std::vector<int> reverses;
+    std::vector<int> twins;
+    std::vector<double> capacities;
+
+    std::vector<int> outOffsets;
+    std::vector<int> outArcs;
+    std::vector<int> inOffsets;
+    std::vector<int> inArcs;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_FLOWGRAPH_H
@@ -0,0 +1,102 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_FLOWGRAPHREDUCER_H
+#define DA_WATERSUPPLYMANAGEMENT_FLOWGRAPHREDUCER_H
+
+#include <vector>
+#include "FlowGraph.h"
+
+/**
+ * @brief Class that shrinks a FlowGraph before a max flow is computed from zero, and maps the flows back to its arcs
+ * @details First, the vertices that cannot be reached from the source or cannot reach the sink are pruned, since they
+ * carry no flow in some max flow. Then, every chain of vertices with exactly two neighbours (like a pumping station with
+ * one pipe in and one pipe out) is contracted into a single link between the ends of the chain, whose capacity in each
+ * direction is the minimum along the chain. Each link becomes one arc of the reduced graph, or two arcs that are the
+ * reverse of each other if the water can go both ways. Every arc of the original graph belongs to at most one link, so
+ * the flow of a link is copied to all its arcs (with the sign of the direction in which the chain crosses them).
+ */
+class FlowGraphReducer {
+public:
+    /**
+     * @brief Constructor of the FlowGraphReducer class
+     * @param graph Graph to reduce
+     */
+    explicit FlowGraphReducer(const FlowGraph &graph);
+
+    /**
+     * @brief Builds the reduced graph from the current capacities of the graph
+     * @details Complexity: O(V+E), where V is the number of vertices and E the number of arcs in the graph.
+     * @param blocked Vector indexed by arc, non-zero for the arcs that cannot be used
+     */
+    void reduce(const std::vector<char> &blocked);
+
+    /**
+     * @brief Returns the reduced graph
+     * @return Constant reference to the reduced graph
+     */
+    const FlowGraph &getReducedGraph() const;
+
+    /**
+     * @brief Returns the blocked arcs of the reduced graph, which are none since the blocked arcs are removed
+     * @return Constant reference to a vector of zeros, indexed by arc of the reduced graph
+     */
+    const std::vector<char> &getReducedBlocked() const;
+
+    /**
+     * @brief Returns the costs of the arcs of the reduced graph, the sums of the costs along their chains
+     * @details Complexity: O(E), where E is the number of arcs in the graph.
+     * @param costs Vector with the cost per unit of flow of each arc of the graph
+     * @return Vector with the cost per unit of flow of each arc of the reduced graph
+     */
+    std::vector<double> reduceCosts(const std::vector<double> &costs) const;
+
+    /**
+     * @brief Maps a flow of the reduced graph to the arcs of the graph
+     * @details The arcs of the pruned vertices and of the chains that were dropped get no flow. Complexity: O(E), where E
+     * is the number of arcs in the graph.
+     * @param reducedFlows Vector with the flows, indexed by arc of the reduced graph
+     * @param flows Vector that will hold the flows, indexed by arc of the graph
+     */
+    void expandFlows(const std::vector<double> &reducedFlows, std::vector<double> &flows) const;
+
+    /**
+     * @brief Returns the number of vertices pruned by the last reduction
+     * @return Number of vertices that cannot be reached from the source or cannot reach the sink
+     */
+    int getNumPrunedVertices() const;
+
+    /**
+     * @brief Returns the number of vertices contracted by the last reduction
+     * @return Number of vertices removed inside chains
+     */
+    int getNumContractedVertices() const;
+
+private:
+    /**
+     * @brief Adds a link between two vertices to the reduced graph, with the arcs of the segments after the last link
+     * @param x Index of the first end, in the graph
+     * @param y Index of the second end, in the graph
+     * @param forward Capacity from x to y
+     * @param backward Capacity from y to x
+     */
+    void addLink(int x, int y, double forward, double backward);
+
+    const FlowGraph &graph;
+    FlowGraph reduced;
+    std::vector<char> reducedBlocked;
+
+    std::vector<int> reducedIndex;
+    std::vector<int> reducedTails;
+    std::vector<int> reducedHeads;
+    std::vector<int> reducedReverses;
+    std::vector<double> reducedCapacities;
+
+    std::vector<int> linkForward;
+    std::vector<int> linkBackward;
+    std::vector<int> linkBegin;
+    std::vector<int> segmentArcs;
+    std::vector<signed char> segmentSigns;
+
+    int numPruned;
+    int numContracted;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_FLOWGRAPHREDUCER_H
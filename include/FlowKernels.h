@@ -0,0 +1,57 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_FLOWKERNELS_H
+#define DA_WATERSUPPLYMANAGEMENT_FLOWKERNELS_H
+
+#include <cstddef>
+
+/**
+ * @brief Bulk operations over the flat per-arc arrays of doubles (capacities and flows)
+ * @details On x86 processors with AVX2 the operations process four doubles at a time, and elsewhere they fall back to
+ * plain loops. The processor is checked once, at the first call, so the same binary runs on any x86 processor. Sums
+ * add the values in a different order with AVX2, which only changes the result for values that are not integers.
+ */
+namespace FlowKernels {
+    /**
+     * @brief Returns whether the vectorized versions of the operations are used
+     * @return True if the processor supports AVX2, false otherwise
+     */
+    bool usesAvx2();
+
+    /**
+     * @brief Sets every value of an array to zero
+     * @details Complexity: O(n).
+     * @param values Pointer to the array
+     * @param count Number of values (n)
+     */
+    void zero(double *values, size_t count);
+
+    /**
+     * @brief Computes the remaining capacity (capacity - flow) of every arc
+     * @details Complexity: O(n).
+     * @param capacities Pointer to the capacities
+     * @param flows Pointer to the flows
+     * @param residuals Pointer to the array that will hold the remaining capacities
+     * @param count Number of arcs (n)
+     */
+    void residuals(const double *capacities, const double *flows, double *residuals, size_t count);
+
+    /**
+     * @brief Adds all the values of an array
+     * @details Complexity: O(n).
+     * @param values Pointer to the array
+     * @param count Number of values (n)
+     * @return Sum of the values
+     */
+    double sum(const double *values, size_t count);
+
+    /**
+     * @brief Adds the values of an array at some indexes, like the flows of the incoming arcs of a vertex
+     * @details Complexity: O(n).
+     * @param values Pointer to the array
+     * @param indexes Pointer to the indexes of the values to add
+     * @param count Number of indexes (n)
+     * @return Sum of the values at the indexes
+     */
+    double sumIndexed(const double *values, const int *indexes, size_t count);
+}
+
+#endif //DA_WATERSUPPLYMANAGEMENT_FLOWKERNELS_H
@@ -0,0 +1,159 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_FLOWSOLVER_H
+#define DA_WATERSUPPLYMANAGEMENT_FLOWSOLVER_H
+
+#include <vector>
+#include "FlowGraph.h"
+#include "AugmentingPathPool.h"
+#include "ParallelBfs.h"
+
+/**
+ * @brief Class that holds a flow over a FlowGraph, along with the scratch memory to change it
+ * @details A solver is not shared between threads: each worker has its own solver (and therefore its own flows, failed
+ * arcs, capacity limits and search buffers) over the same graph. Since each arc has the index of its pipe, a decomposition saved by the
+ * water supply network can be used directly to repair the flow.
+ */
+class FlowSolver {
+public:
+    /**
+     * @brief Constructor of the FlowSolver class, with all flows set to zero
+     * @details Complexity: O(V+E), where V is the number of vertices and E the number of arcs in the graph.
+     * @param graph Graph over which the flows are computed
+     */
+    explicit FlowSolver(const FlowGraph &graph);
+
+    /**
+     * @brief Returns the graph of the solver
+     * @return Constant reference to the graph
+     */
+    const FlowGraph &getGraph() const;
+
+    /**
+     * @brief Sets the flow of every arc to zero
+     * @details Complexity: O(E), where E is the number of arcs in the graph.
+     */
+    void resetFlows();
+
+    /**
+     * @brief Sets the flows of the arcs
+     * @details Complexity: O(E), where E is the number of arcs in the graph.
+     * @param flows Vector with the flows, indexed by arc
+     */
+    void setFlows(const std::vector<double> &flows);
+
+    /**
+     * @brief Returns the flows of the arcs
+     * @return Constant reference to the vector with the flows, indexed by arc
+     */
+    const std::vector<double> &getFlows() const;
+
+    /**
+     * @brief Returns the flow through an arc
+     * @param arc Index of the arc
+     * @return Flow through the arc
+     */
+    double getFlow(int arc) const;
+
+    /**
+     * @brief Marks an arc (and its reverse or its twin) as failed, so that the searches no longer use it
+     * @details Complexity: O(1).
+     * @param arc Index of the arc
+     */
+    void failArc(int arc);
+
+    /**
+     * @brief Lowers the capacity of an arc for the searches of this solver, without changing the graph
+     * @details The flow already in the arc is not changed, so the paths through it must be subtracted before augmenting
+     * (see subtractPaths). Complexity: O(1).
+     * @param arc Index of the arc
+     * @param capacity New capacity of the arc, which should not be above the one of the graph
+     */
+    void limitArc(int arc, double capacity);
+
+    /**
+     * @brief Marks all the arcs as not failed and restores the capacities of the limited arcs
+     * @details Complexity: O(n), where n is the number of failed and limited arcs.
+     */
+    void clearFailures();
+
+    /**
+     * @brief Sets the number of threads of the searches of augment, for very large graphs (see ParallelBfs)
+     * @details Solvers start with one thread, since they are usually run in parallel with each other.
+     * @param numThreads Number of threads (0 to use the number of hardware threads)
+     */
+    void setBfsThreads(unsigned numThreads);
+
+    /**
+     * @brief Subtracts from the flow the augmenting paths of a decomposition that pass through some arcs
+     * @details The paths that pass through an unidirectional arc that becomes with a negative flow, or through an arc
+     * that becomes with a flow over its capacity, are also subtracted.
+     * Complexity: O(n*V), where n is the number of paths subtracted and V the number of vertices in the graph.
+     * @param paths Decomposition of the flow currently in the solver
+     * @param arcs Vector with the indexes of the arcs
+     */
+    void subtractPaths(const AugmentingPathPool &paths, const std::vector<int> &arcs);
+
+    /**
+     * @brief Augments the current flow with the Edmonds Karp algorithm until it is maximum
+     * @details Complexity: O(V*E^2), where V is the number of vertices and E the number of arcs in the graph. In a
+     * pseudopolinomial perspective, it has complexity O(E*f), where f is the flow added.
+     * @return Value of the flow added
+     */
+    double augment();
+
+    /**
+     * @brief Returns the value of the flow that reaches the sink
+     * @details Complexity: O(n), where n is the number of incoming arcs of the sink.
+     * @return Value of the flow
+     */
+    double getFlowValue() const;
+
+    /**
+     * @brief Returns the flow that enters a vertex
+     * @details Complexity: O(n), where n is the number of incoming arcs of the vertex.
+     * @param v Index of the vertex
+     * @return Sum of the flows of the incoming arcs of the vertex
+     */
+    double getInflow(int v) const;
+
+private:
+    /**
+     * @brief Performs a BFS on the residual graph, from the source to the sink
+     * @details The parallel BFS is used instead if it is worth it for the graph. Complexity: O(V+E), where V is the number of vertices and E the number of arcs in the graph.
+     * @return True if the sink was reached, false otherwise
+     */
+    bool bfs();
+
+    /**
+     * @brief Adds flow to an arc in one of the directions, updating its reverse
+     * @param arc Index of the arc
+     * @param direct True if the flow goes in the direction of the arc, false otherwise
+     * @param value Value of the flow to add
+     */
+    void pushFlow(int arc, bool direct, double value);
+
+    /**
+     * @brief Selects the augmenting paths that pass through an arc and were not selected yet
+     * @param paths Decomposition of the flow
+     * @param arc Index of the arc
+     */
+    void selectPaths(const AugmentingPathPool &paths, int arc);
+
+    const FlowGraph &graph;
+    std::vector<double> flows;
+    std::vector<char> failed;
+    std::vector<int> failedArcs;
+    std::vector<double> capacities;
+    std::vector<int> limitedArcs;
+
+    std::vector<int> parentArc;
+    std::vector<char> parentDirect;
+    std::vector<unsigned> visited;
+    unsigned visitStamp;
+    std::vector<int> queue;
+    ParallelBfs parallelBfs;
+
+    std::vector<char> pathSelected;
+    std::vector<int> selectedPaths;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_FLOWSOLVER_H
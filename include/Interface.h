@@ -2,6 +2,9 @@
 #define DA_WATERSUPPLYMANAGEMENT_INTERFACE_H
 
 #include "WaterSupplyNetwork.h"
+#include "ReportWriter.h"
+#include "ScenarioResultStore.h"
+#include "FailureBenchmark.h"
 
 /**
  * @brief Class that represents the interface of the program
@@ -121,16 +124,64 @@ public:
     void saveCriticalPipesToFile(const std::string& title, const std::vector<Pipe *> pipes);
 
     /**
-     * @brief Saves the metrics calculated
+     * @brief Saves the worst combinations of failures for each city
+     * @param title Text to be written to the file as the title
+     * @param failureReport Report with the worst combinations of failures
+     */
+    void saveWorstFailuresToFile(const std::string& title, const FailureReport &failureReport);
+
+    /**
+     * @brief Saves the flow of each city in the minimum cost max flow, followed by the total flow and cost
+     * @param title Text to be written to the file as the title
+     * @param flow Value of the max flow
+     * @param cost Total pumping cost of the flow
+     */
+    void saveMinCostFlowToFile(const std::string& title, double flow, double cost);
+
+    /**
+     * @brief Saves the network flow and the number of cities with less supply in the outage and in the drought of each
+     * reservoir to the output file
+     * @param title Title of the section
+     * @param outages Store with the supplies of the cities in the outage of each reservoir
+     * @param droughts Store with the supplies of the cities in the drought of each reservoir
+     */
+    void saveReservoirOutagesToFile(const std::string& title, const ScenarioResultStore &outages, const ScenarioResultStore &droughts);
+
+    /**
+     * @brief Saves the throughput of each pumping station, the network flow with it degraded and the number of cities
+     * with less supply to the output file
+     * @param title Title of the section
+     * @param degradations Store with the supplies of the cities in the degradation of each station
+     */
+    void saveStationDegradationsToFile(const std::string& title, const ScenarioResultStore &degradations);
+
+    /**
+     * @brief Saves the max flows and the times of the incremental and brute-force algorithms for the failure of each
+     * element, followed by the summary of each kind of element, to the output file
+     * @param title Title of the sections
+     * @param benchmark Benchmark that was run
+     */
+    void saveFailureBenchmarkToFile(const std::string& title, const FailureBenchmark &benchmark);
+
+    /**
+     * @brief Saves the factor of the demands up to which each city is sure to be fully supplied
+     * @param title Text to be written to the file as the title
+     * @param breakpoints Vector with each city and its factor, sorted by factor
+     */
+    void saveDemandBreakpointsToFile(const std::string& title, const std::vector<std::pair<DeliverySite*, double>> &breakpoints);
+
+    /**
+     * @brief Saves the metrics calculated, as a row of the section started by saveTitleToFile
      * @param metrics Tuple containing the values in order: Max, Mean, Variance
      */
     void saveMetricsToFile(std::tuple<double, double, double> &metrics);
 
     /**
-     * @brief Writes just the title to the file
+     * @brief Writes just the title to the file, starting a section whose rows are written afterwards
      * @param title Text to be written to the file as the title
+     * @param columns Names of the columns of the rows
      */
-    void saveTitleToFile(const std::string& title);
+    void saveTitleToFile(const std::string& title, const std::vector<std::string>& columns);
 
     /**
      * @brief Menu to select whether to add more pipes or process the operation
@@ -138,6 +189,12 @@ public:
      */
     bool pipeMenu();
 
+    /**
+     * @brief Menu to select the maximum number of simultaneous failures to analyse
+     * @return The number of simultaneous failures selected, or 0 to go back
+     */
+    int failureCountMenu();
+
     /**
      * @brief Main menu to select which function should be processed
      */
@@ -257,6 +314,40 @@ public:
      */
     void displayCriticalPipes(const std::vector<Pipe *> &pipes);
 
+    /**
+     * @brief Displays the worst combinations of failures for the cities that can be affected
+     * @param report Report with the worst combinations of failures
+     */
+    void displayWorstFailures(const FailureReport &report);
+
+    /**
+     * @brief Displays the factor of the demands up to which each city is sure to be fully supplied
+     * @param breakpoints Vector with each city and its factor, sorted by factor
+     */
+    void displayDemandBreakpoints(const std::vector<std::pair<DeliverySite*, double>> &breakpoints);
+
+    /**
+     * @brief Displays the network flow in the outage and in the drought of each reservoir, and the number of cities
+     * with less supply in the outage
+     * @param outages Store with the supplies of the cities in the outage of each reservoir
+     * @param droughts Store with the supplies of the cities in the drought of each reservoir
+     */
+    void displayReservoirOutages(const ScenarioResultStore &outages, const ScenarioResultStore &droughts);
+
+    /**
+     * @brief Displays the throughput of each pumping station, the network flow with it degraded and the number of
+     * cities with less supply
+     * @param degradations Store with the supplies of the cities in the degradation of each station
+     */
+    void displayStationDegradations(const ScenarioResultStore &degradations);
+
+    /**
+     * @brief Displays the times and the speedup percentiles of the incremental failure algorithms for each kind of
+     * element, and the failures in which they diverge from the brute-force ones
+     * @param benchmark Benchmark that was run
+     */
+    void displayFailureBenchmark(const FailureBenchmark &benchmark);
+
     /**
      * @brief Displays information for a set of cities
      * @param cities Vector containing the cities to display
@@ -281,6 +372,12 @@ public:
      */
     void pipeDisplay(const ServicePoint *servicePoint);
 
+    /**
+     * @brief Displays the parts of the network that do not share any pipe, with their max flows, and the service points
+     * and pipes whose failure splits a part
+     */
+    void networkStructureDisplay();
+
 private:
     int infoSpacing = 8;
     int width = 80;
@@ -290,7 +387,15 @@ private:
     std::vector<Pipe *> selectedPipes;
 
     bool outputToFile = false;
-    std::string fileName = "../output.txt";
+    std::string fileName = "../output";
+    ReportFormat outputFormat = REPORT_TEXT;
+    std::string sweepFileName = "../failures.wsns";
+    std::string profileFileName = "../profile.csv";
+    std::string timeSeriesFileName = "../timeseries.wsns";
+    double balanceTimeBudget = 30;
+    double droughtCapacityFactor = 0.4;
+    double stationDegradationFactor = 0.5;
+    ReportWriter report;
 };
 
 #endif //DA_WATERSUPPLYMANAGEMENT_INTERFACE_H
@@ -0,0 +1,133 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_METRICSACCUMULATOR_H
+#define DA_WATERSUPPLYMANAGEMENT_METRICSACCUMULATOR_H
+
+#include <vector>
+#include <tuple>
+#include <cstddef>
+
+/**
+ * @brief Class that keeps the maximum, mean, variance and quantiles of a set of values, one for each key
+ * @details The keys are small integers (like the index of a pipe), and the value of a key can be set, changed or erased
+ * at any time. The mean and variance are updated in O(1) with Welford's method, and the quantiles are estimated with a
+ * sketch of logarithmic buckets, which has a relative error of at most 1%. The maximum is exact: it is kept while it is
+ * not erased or decreased, and is only recalculated from all the values when that happens.
+ */
+class MetricsAccumulator {
+public:
+    /**
+     * @brief Constructor of the MetricsAccumulator class, without values
+     */
+    MetricsAccumulator();
+
+    /**
+     * @brief Erases all the values
+     * @details Complexity: O(n), where n is the number of keys.
+     * @param numKeys Number of keys that will be used, from 0 to numKeys-1
+     */
+    void reset(size_t numKeys);
+
+    /**
+     * @brief Sets the value of a key, replacing its previous value if it has one
+     * @details Complexity: O(1).
+     * @param key Key of the value
+     * @param value New value
+     */
+    void set(int key, double value);
+
+    /**
+     * @brief Erases the value of a key, if it has one
+     * @details Complexity: O(1).
+     * @param key Key of the value
+     */
+    void erase(int key);
+
+    /**
+     * @brief Returns the number of values
+     * @return Number of keys with a value
+     */
+    size_t getCount() const;
+
+    /**
+     * @brief Returns the largest value
+     * @details Complexity: O(1), or O(n) if the maximum was erased or decreased, where n is the number of keys.
+     * @return Largest value, or 0 if there are no values
+     */
+    double getMax() const;
+
+    /**
+     * @brief Returns the mean of the values
+     * @return Mean of the values, or 0 if there are no values
+     */
+    double getMean() const;
+
+    /**
+     * @brief Returns the (population) variance of the values
+     * @return Variance of the values, or 0 if there are no values
+     */
+    double getVariance() const;
+
+    /**
+     * @brief Estimates a quantile of the values
+     * @details Complexity: O(b), where b is the number of buckets of the sketch.
+     * @param q Fraction of the values that should be smaller than the quantile, from 0 to 1
+     * @return Estimate of the quantile, or 0 if there are no values
+     */
+    double getQuantile(double q) const;
+
+    /**
+     * @brief Returns the maximum, the mean and the variance of the values
+     * @return Tuple with the maximum, the mean and the variance
+     */
+    std::tuple<double, double, double> getMetrics() const;
+
+private:
+    /**
+     * @brief Adds a value to the running statistics and to the sketch
+     * @param value Value to add
+     */
+    void add(double value);
+
+    /**
+     * @brief Removes a value from the running statistics and from the sketch
+     * @param value Value to remove
+     */
+    void remove(double value);
+
+    /**
+     * @brief Returns the bucket of the sketch of a value
+     * @details Bucket 0 holds the values close to zero, positive buckets hold positive values and negative buckets
+     * hold negative values, each bucket covering values whose ratio is at most the growth factor of the sketch.
+     * @param value Value to place
+     * @return Index of the bucket
+     */
+    static int getBucket(double value);
+
+    /**
+     * @brief Returns the value that represents a bucket of the sketch
+     * @param bucket Index of the bucket
+     * @return Value in the middle of the bucket, in relative terms
+     */
+    static double getBucketValue(int bucket);
+
+    /**
+     * @brief Returns the count of a bucket, growing the sketch if needed
+     * @param bucket Index of the bucket
+     * @return Reference to the count of the bucket
+     */
+    size_t &getBucketCount(int bucket);
+
+    std::vector<double> values;
+    std::vector<bool> present;
+
+    size_t count;
+    double mean;
+    double m2;
+
+    mutable double maxValue;
+    mutable bool maxValid;
+
+    std::vector<size_t> positiveBuckets;
+    std::vector<size_t> negativeBuckets;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_METRICSACCUMULATOR_H
@@ -0,0 +1,71 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_MINCOSTFLOWSOLVER_H
+#define DA_WATERSUPPLYMANAGEMENT_MINCOSTFLOWSOLVER_H
+
+#include <vector>
+#include "FlowGraph.h"
+
+/**
+ * @brief Class that computes a max flow with minimum cost over a FlowGraph
+ * @details Each arc has a cost per unit of flow, which must not be negative. The flow is built with successive shortest
+ * paths: each augmenting path is the cheapest path from the source to the sink in the residual graph, found with the
+ * Dijkstra algorithm over costs reduced by vertex potentials (Johnson's technique), so that the backward residual arcs
+ * never have negative reduced costs. The two arcs of a bidirectional pipe are used as independent arcs, and their flows
+ * are combined into a skew-symmetric flow at the end, like the flows of the water supply network.
+ */
+class MinCostFlowSolver {
+public:
+    /**
+     * @brief Constructor of the MinCostFlowSolver class, with all flows set to zero
+     * @details Complexity: O(V+E), where V is the number of vertices and E the number of arcs in the graph.
+     * @param graph Graph over which the flow is computed
+     * @param costs Vector with the cost per unit of flow of each arc, indexed by arc
+     */
+    MinCostFlowSolver(const FlowGraph &graph, const std::vector<double> &costs);
+
+    /**
+     * @brief Computes the max flow with minimum cost from the source to the sink of the graph
+     * @details Complexity: O(F*E*log(V)), where F is the number of augmenting paths, V the number of vertices and E the
+     * number of arcs in the graph.
+     * @return Value of the max flow
+     */
+    double solve();
+
+    /**
+     * @brief Returns the flows of the arcs
+     * @return Constant reference to the vector with the flows, indexed by arc
+     */
+    const std::vector<double> &getFlows() const;
+
+    /**
+     * @brief Returns the total cost of the flow
+     * @details Complexity: O(E), where E is the number of arcs in the graph.
+     * @return Sum of the flow times the cost of every arc with positive flow
+     */
+    double getCost() const;
+
+private:
+    /**
+     * @brief Finds the cheapest augmenting path with the Dijkstra algorithm, and updates the potentials
+     * @details Residual arcs are numbered 2*arc for the arc itself and 2*arc+1 for its backward arc.
+     * @return True if the sink can be reached, false otherwise
+     */
+    bool findShortestPath();
+
+    /**
+     * @brief Returns the residual capacity of a residual arc
+     * @param residual Index of the residual arc
+     * @return Residual capacity
+     */
+    double getResidual(int residual) const;
+
+    const FlowGraph &graph;
+    std::vector<double> costs;
+    std::vector<double> sent;
+    std::vector<double> flows;
+
+    std::vector<double> potentials;
+    std::vector<double> distances;
+    std::vector<int> parentResiduals;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_MINCOSTFLOWSOLVER_H
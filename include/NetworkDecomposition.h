@@ -0,0 +1,165 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_NETWORKDECOMPOSITION_H
+#define DA_WATERSUPPLYMANAGEMENT_NETWORKDECOMPOSITION_H
+
+#include <vector>
+#include "FlowGraph.h"
+
+/**
+ * @brief Class that splits a FlowGraph in the parts of the network that do not share any pipe
+ * @details The components are the weakly connected components of the network without the super source and the super
+ * sink, so the water of a component never reaches another one and the max flow is the sum of the max flows of the
+ * components. Each arc of the super source or super sink belongs to the component of its other end. The components
+ * are solved independently (and in parallel), and after a failure only the components that contain the failed arcs
+ * need to be solved again. The articulation points (vertices whose removal splits their component) and the bridges
+ * (arcs whose removal splits their component) are found as well, as hints of where the network is fragile. Only the
+ * topology is stored, so the capacities of the graph can change between solves.
+ */
+class NetworkDecomposition {
+public:
+    /**
+     * @brief Constructor of the NetworkDecomposition class, with no components
+     */
+    NetworkDecomposition();
+
+    /**
+     * @brief Finds the components, the articulation points and the bridges of a graph
+     * @details Complexity: O(V+E), where V is the number of vertices and E the number of arcs in the graph.
+     * @param graph Graph to decompose
+     */
+    void build(const FlowGraph &graph);
+
+    /**
+     * @brief Returns the number of components
+     * @return Number of components
+     */
+    int getNumComponents() const;
+
+    /**
+     * @brief Returns the component of a vertex
+     * @param v Index of the vertex
+     * @return Index of the component, or -1 for the source and the sink
+     */
+    int getComponent(int v) const;
+
+    /**
+     * @brief Returns the component of an arc
+     * @param arc Index of the arc
+     * @return Index of the component, or -1 for arcs between the source and the sink
+     */
+    int getArcComponent(int arc) const;
+
+    /**
+     * @brief Returns the vertices of a component
+     * @param component Index of the component
+     * @return Constant reference to the vector with the indexes of the vertices, in increasing order
+     */
+    const std::vector<int> &getComponentVertices(int component) const;
+
+    /**
+     * @brief Returns the arcs of a component, including the ones of the source and the sink
+     * @param component Index of the component
+     * @return Constant reference to the vector with the indexes of the arcs, in increasing order
+     */
+    const std::vector<int> &getComponentArcs(int component) const;
+
+    /**
+     * @brief Checks if a vertex is an articulation point of its component
+     * @param v Index of the vertex
+     * @return True if removing the vertex splits its component, false otherwise
+     */
+    bool isArticulationPoint(int v) const;
+
+    /**
+     * @brief Checks if an arc is a bridge of its component
+     * @details Both arcs of a bidirectional pipe are bridges or neither is, and two pipes between the same vertices are
+     * never bridges.
+     * @param arc Index of the arc
+     * @return True if removing the arc (and its reverse) splits its component, false otherwise
+     */
+    bool isBridge(int arc) const;
+
+    /**
+     * @brief Checks if removing an arc leaves a vertex without any path to the vertices fed by the source
+     * @details The arc must be a bridge, and the side of the bridge with the vertex must not have any vertex with an arc
+     * from the source (like a reservoir), so no water can reach the vertex after the arc fails. Complexity: O(1).
+     * @param arc Index of the arc
+     * @param v Index of the vertex
+     * @return True if the arc is a bridge that cuts the vertex off from the source, false otherwise
+     */
+    bool separatesFromSource(int arc, int v) const;
+
+    /**
+     * @brief Calculates the flow that reaches the sink through a component
+     * @details Complexity: O(E), where E is the number of arcs of the component.
+     * @param graph Graph that was decomposed
+     * @param flows Vector with the flow of each arc of the graph
+     * @param component Index of the component
+     * @return Flow of the arcs of the component into the sink
+     */
+    double getComponentFlow(const FlowGraph &graph, const std::vector<double> &flows, int component) const;
+
+    /**
+     * @brief Calculates the max flow of some components from zero, in parallel
+     * @details The flows of the arcs of the components are replaced, and the other flows are not touched. Each
+     * component is copied to a graph of its own, which is reduced (see FlowGraphReducer) and solved by push relabel.
+     * When there is a single component, its solver uses all the threads instead. Complexity: O(V^2*E) for each
+     * component, where V is the number of vertices and E the number of arcs of the component.
+     * @param graph Graph that was decomposed, with the current capacities
+     * @param components Vector with the indexes of the components to solve
+     * @param flows Vector with the flow of each arc of the graph, which will hold the new flows
+     * @param blocked Vector indexed by arc, non-zero for the arcs that cannot be used
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     * @return Sum of the max flows of the components
+     */
+    double solveComponents(const FlowGraph &graph, const std::vector<int> &components, std::vector<double> &flows,
+                           const std::vector<char> &blocked, unsigned numThreads) const;
+
+    /**
+     * @brief Calculates the max flow of the whole graph from zero, solving the components in parallel
+     * @details Complexity: O(V^2*E) for each component, where V is the number of vertices and E the number of arcs of
+     * the component.
+     * @param graph Graph that was decomposed, with the current capacities
+     * @param flows Vector that will hold the flow of each arc of the graph
+     * @param blocked Vector indexed by arc, non-zero for the arcs that cannot be used
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     * @return Value of the max flow
+     */
+    double solve(const FlowGraph &graph, std::vector<double> &flows, const std::vector<char> &blocked,
+                 unsigned numThreads) const;
+
+private:
+    /**
+     * @brief Finds the articulation points and the bridges with an iterative depth-first search (Tarjan)
+     * @details The search also keeps, for each vertex, the size of its subtree and how many of its vertices are fed by
+     * the source, and for each bridge the vertex below it. Complexity: O(V+E), where V is the number of vertices and E
+     * the number of arcs in the graph.
+     * @param graph Graph to decompose
+     */
+    void findArticulations(const FlowGraph &graph);
+
+    /**
+     * @brief Calculates the max flow of one component from zero
+     * @param graph Graph that was decomposed, with the current capacities
+     * @param component Index of the component
+     * @param flows Vector with the flow of each arc of the graph, which will hold the new flows of the component
+     * @param blocked Vector indexed by arc, non-zero for the arcs that cannot be used
+     * @param numThreads Number of threads used by the solver of the component
+     * @return Max flow of the component
+     */
+    double solveComponent(const FlowGraph &graph, int component, std::vector<double> &flows,
+                          const std::vector<char> &blocked, unsigned numThreads) const;
+
+    std::vector<int> vertexComponents;
+    std::vector<int> arcComponents;
+    std::vector<std::vector<int>> componentVertices;
+    std::vector<std::vector<int>> componentArcs;
+    std::vector<char> articulationPoints;
+    std::vector<char> bridges;
+    std::vector<int> bridgeChildren;
+    std::vector<int> discovery;
+    std::vector<int> subtreeSizes;
+    std::vector<int> subtreeSources;
+    std::vector<int> componentSources;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_NETWORKDECOMPOSITION_H
@@ -0,0 +1,144 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_PARALLELBFS_H
+#define DA_WATERSUPPLYMANAGEMENT_PARALLELBFS_H
+
+#include <vector>
+#include <memory>
+#include "FlowGraph.h"
+#include "TaskScheduler.h"
+
+/**
+ * @brief Class that performs a level-synchronous BFS of the residual graph of a flow, spread over several threads
+ * @details Each level is expanded either top-down (the arcs of the frontier are scanned, in chunks of the frontier) or
+ * bottom-up (each unvisited vertex looks for a parent in a bitmap of the frontier, in chunks of the vertices), choosing
+ * the direction that scans fewer arcs (direction-optimizing BFS). Levels with little work are expanded in the calling
+ * thread. The parents found do not depend on the number of threads: in top-down levels the candidates of the chunks are
+ * merged in the order of the frontier, and in bottom-up levels each vertex takes the first parent in the order of its
+ * arcs. Like the sequential BFS, the paths found are shortest paths, so Edmonds Karp keeps its bounds. Only worth it for
+ * very large graphs, see MIN_VERTICES.
+ */
+class ParallelBfs {
+public:
+    /**
+     * @brief Smallest number of vertices for which the parallel BFS is used instead of the sequential one
+     */
+    static const int MIN_VERTICES = 50000;
+
+    /**
+     * @brief Constructor of the ParallelBfs class
+     * @param graph Graph to search
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     */
+    ParallelBfs(const FlowGraph &graph, unsigned numThreads);
+
+    /**
+     * @brief Sets the number of threads to use
+     * @param numThreads Number of threads (0 to use the number of hardware threads, 1 to never use the parallel BFS)
+     */
+    void setNumThreads(unsigned numThreads);
+
+    /**
+     * @brief Sets the scheduler that runs the levels, so that its threads can be kept between several searches
+     * @details Without one, a scheduler is started by the first level that needs it and kept until the number of
+     * threads changes.
+     * @param scheduler Scheduler with the number of threads of the search
+     */
+    void setScheduler(const std::shared_ptr<TaskScheduler> &scheduler);
+
+    /**
+     * @brief Returns whether the parallel BFS should be used for the graph
+     * @return True if the graph has at least MIN_VERTICES vertices and more than one thread is used, false otherwise
+     */
+    bool isWorthIt() const;
+
+    /**
+     * @brief Searches the residual graph from the source, until the level of the sink is complete
+     * @details An arc can be used forward if it has remaining capacity, and backward if it has positive flow, unless it
+     * is blocked. Complexity: O(V+E), where V is the number of vertices and E the number of arcs in the graph.
+     * @param flows Vector with the flows, indexed by arc
+     * @param capacities Vector with the capacities, indexed by arc (usually the ones of the graph)
+     * @param blocked Vector indexed by arc, non-zero for the arcs that cannot be used
+     * @param parentArc Vector that will hold the arc used to reach each reached vertex
+     * @param parentDirect Vector that will hold, for each reached vertex, whether its arc was used forward
+     * @return True if the sink was reached, false otherwise
+     */
+    bool search(const std::vector<double> &flows, const std::vector<double> &capacities, const std::vector<char> &blocked,
+                std::vector<int> &parentArc, std::vector<char> &parentDirect);
+
+    /**
+     * @brief Searches the residual graph backwards from the sink, finding the vertices that can still send water to it
+     * @details A vertex can send water to the vertex found before it through an arc between them with more than epsilon
+     * of remaining capacity, or through an arc in the opposite direction with more than epsilon of flow, unless the arc is
+     * blocked. The vertices found are the ones reached (see isReached). Complexity: O(V+E), where V is the number of
+     * vertices and E the number of arcs in the graph.
+     * @param flows Vector with the flows, indexed by arc
+     * @param capacities Vector with the capacities, indexed by arc
+     * @param blocked Vector indexed by arc, non-zero for the arcs that cannot be used
+     * @param epsilon Smallest remaining capacity or flow for an arc to be used
+     */
+    void searchToSink(const std::vector<double> &flows, const std::vector<double> &capacities,
+                      const std::vector<char> &blocked, double epsilon);
+
+    /**
+     * @brief Returns whether a vertex was reached by the last search
+     * @param v Index of the vertex
+     * @return True if the vertex was reached, false otherwise
+     */
+    bool isReached(int v) const;
+
+private:
+    /**
+     * @brief Vertex discovered in a top-down level, with the arc that reached it
+     */
+    struct Candidate {
+        int vertex;
+        int arc;
+        bool direct;
+    };
+
+    /**
+     * @brief Returns the number of arcs (incoming and outgoing) of a vertex
+     * @param v Index of the vertex
+     * @return Degree of the vertex
+     */
+    int getDegree(int v) const;
+
+    /**
+     * @brief Expands the levels of a search of the residual graph, from a vertex until the level of another is complete
+     * @details Complexity: O(V+E), where V is the number of vertices and E the number of arcs in the graph.
+     * @param start Index of the vertex where the search starts
+     * @param stop Index of the vertex that ends the search, or -1 to reach every vertex possible
+     * @param backward True to follow the arcs against the water, finding the vertices that can send water to the start
+     * @param epsilon Smallest remaining capacity or flow for an arc to be used
+     * @param flows Vector with the flows, indexed by arc
+     * @param capacities Vector with the capacities, indexed by arc
+     * @param blocked Vector indexed by arc, non-zero for the arcs that cannot be used
+     * @param parentArc Vector that will hold the arc used to reach each reached vertex, or null
+     * @param parentDirect Vector that will hold whether the arc of each reached vertex was used forward, or null
+     * @return True if the stop vertex was reached, false otherwise
+     */
+    bool expand(int start, int stop, bool backward, double epsilon, const std::vector<double> &flows,
+                const std::vector<double> &capacities, const std::vector<char> &blocked, std::vector<int> *parentArc,
+                std::vector<char> *parentDirect);
+
+    /**
+     * @brief Runs the chunks of a level, in several threads if there is enough work
+     * @param numChunks Number of chunks
+     * @param work Number of arcs that the level scans, roughly
+     * @param chunk Function that expands one chunk
+     */
+    template<class F>
+    void runChunks(size_t numChunks, long work, const F &chunk);
+
+    const FlowGraph &graph;
+    unsigned numThreads;
+    std::shared_ptr<TaskScheduler> scheduler;
+
+    std::vector<unsigned> visited;
+    unsigned visitStamp;
+    std::vector<int> frontier;
+    std::vector<char> inFrontier;
+    std::vector<std::vector<Candidate>> chunkCandidates;
+    std::vector<std::vector<int>> chunkVertices;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_PARALLELBFS_H
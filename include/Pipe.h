@@ -3,11 +3,9 @@
 
 #include "Edge.h"
 #include "ServicePoint.h"
-#include "AugmentingPath.h"
 #include <string>
 
 class ServicePoint;
-class AugmentingPath;
 
 /**
  * @brief Class representation of a pipe in a water supply network
@@ -46,6 +44,27 @@ public:
      */
     Pipe *getReverse() const;
 
+    /**
+     * @brief Returns the other direction of a bidirectional pipe that was split in two unidirectional pipes
+     * @details A bidirectional pipe of a pumping station with a throughput limit leaves the station from its outlet, so
+     * its two directions do not connect the same service points and cannot be the reverse of each other. They are twins
+     * instead, which fail and are hidden together.
+     * @return Pointer to the twin pipe, or nullptr if the pipe was not split
+     */
+    Pipe *getTwin() const;
+
+    /**
+     * @brief Sets the other direction of a bidirectional pipe that was split in two unidirectional pipes
+     * @param twin Pointer to the twin pipe
+     */
+    void setTwin(Pipe *twin);
+
+    /**
+     * @brief Returns whether the pipe is bidirectional in the dataset
+     * @return True if the pipe has a reverse or a twin, false otherwise
+     */
+    bool isBidirectional() const;
+
     /**
      * @brief Returns the remaining flow (capacity - flow) of the pipe
      * @return The remaining flow of the pipe
@@ -65,28 +84,36 @@ public:
     void setHidden(bool hidden);
 
     /**
-     * @brief Sets the capacity of the pipe
-     * @param capacity The capacity of the pipe
+     * @brief Sets the flow of the pipe, updating the totals of flow of its service points
+     * @details Edge::setFlow only sets the flow of the edge and is private in this class, so the flows of the pipes
+     * are always set through this function. Complexity: O(1).
+     * @param flow New flow of the pipe
      */
-    void setCapacity(double capacity);
+    void updateFlow(double flow);
 
     /**
-     * @brief Returns the augmenting paths associated with the pipe
-     * @return Constant reference to a vector with pointers to the augmenting paths associated with the pipe
+     * @brief Returns the cost of moving one unit of flow through the pipe
+     * @return The cost per unit of flow of the pipe
      */
-    const std::vector<AugmentingPath*> &getAugmentingPaths() const;
+    double getCost() const;
 
     /**
-     * @brief Returns the augmenting paths that pass through the pipe
-     * @return Reference to a vector with pointers to the augmenting paths associated with the pipe
+     * @brief Sets the cost of moving one unit of flow through the pipe
+     * @param cost The cost per unit of flow of the pipe
      */
-    std::vector<AugmentingPath*> &getAugmentingPaths();
+    void setCost(double cost);
 
     /**
-     * @brief Marks all the augmenting paths that pass through the pipe
-     * @details Complexity: O(n), where n is the number of augmenting paths that pass through the pipe
+     * @brief Returns the index of the pipe in the network
+     * @return Index of the pipe, or -1 if the pipe was not indexed
      */
-    void selectAugmentingPaths() const;
+    int getIndex() const;
+
+    /**
+     * @brief Sets the index of the pipe in the network
+     * @param index Index of the pipe
+     */
+    void setIndex(int index);
 
     /**
      * @brief Equality operator
@@ -96,8 +123,23 @@ public:
     bool operator==(const Pipe &pipe) const;
 
 private:
-    std::vector<AugmentingPath*> augmentingPaths;
+    friend class WaterSupplyNetwork;
+
+    /**
+     * @brief Sets the capacity of the pipe
+     * @details Private (and hides Edge::setWeight), so every change of capacity goes through
+     * WaterSupplyNetwork::setPipeCapacity and updates the version of the network.
+     * @param capacity The capacity of the pipe
+     */
+    void setCapacity(double capacity);
+
+    using Edge<std::string>::setWeight;
+    using Edge<std::string>::setFlow;
+
+    int index;
     bool hidden;
+    double cost;
+    Pipe *twin;
 };
 
 #endif //DA_WATERSUPPLYMANAGEMENT_PIPE_H
@@ -24,6 +24,49 @@ public:
      * @return String with a description (code) of the pumping station
      */
     std::string getDescription() const;
+
+    /**
+     * @brief Returns the cost of pumping one unit of flow through the pumping station
+     * @return The pumping cost per unit of flow
+     */
+    double getPumpingCost() const;
+
+    /**
+     * @brief Sets the cost of pumping one unit of flow through the pumping station
+     * @param pumpingCost The pumping cost per unit of flow
+     */
+    void setPumpingCost(double pumpingCost);
+
+    /**
+     * @brief Returns the maximum flow that the pumping station can pump
+     * @return The throughput limit of the pumping station (infinity if it has no limit)
+     */
+    double getCapacity() const;
+
+    /**
+     * @brief Sets the maximum flow that the pumping station can pump
+     * @details It only has effect if set before the pipes of the station are added, since the station is split in two
+     * vertices when the network is built (see StationOutlet).
+     * @param capacity The throughput limit of the pumping station
+     */
+    void setCapacity(double capacity);
+
+    /**
+     * @brief Returns the outlet of the pumping station, which holds its outgoing pipes
+     * @return Pointer to the outlet, or nullptr if the station has no throughput limit
+     */
+    ServicePoint *getOutlet() const;
+
+    /**
+     * @brief Sets the outlet of the pumping station
+     * @param outlet Pointer to the outlet
+     */
+    void setOutlet(ServicePoint *outlet);
+
+private:
+    double pumpingCost;
+    double capacity;
+    ServicePoint *outlet;
 };
 
 
@@ -0,0 +1,99 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_PUSHRELABELSOLVER_H
+#define DA_WATERSUPPLYMANAGEMENT_PUSHRELABELSOLVER_H
+
+#include <vector>
+#include <atomic>
+#include "FlowGraph.h"
+#include "TaskScheduler.h"
+
+/**
+ * @brief Class that computes a max flow over a FlowGraph with a synchronous parallel push relabel algorithm
+ * @details The algorithm works in rounds. In each round, the active vertices (the ones with excess) are discharged
+ * concurrently, using the labels of the start of the round: a vertex only pushes to neighbours with a label one below
+ * its own, so the two vertices of a pipe never push through it in the same round and the flows need no locks. The
+ * excess sent to a neighbour is added atomically to its incoming excess, which is only merged at the end of the round.
+ * The vertices that kept excess are then relabeled, also from the labels of the start of the round, and the labels are
+ * recomputed exactly with a BFS from the sink (global relabeling) every time the vertices were relabeled about V times.
+ * Excess that cannot reach the sink goes back to the source, so the result is a flow and not just a preflow. The flows
+ * are in the same arrays as the ones of FlowSolver (indexed by arc, skew-symmetric for bidirectional pipes).
+ */
+class PushRelabelSolver {
+public:
+    /**
+     * @brief Constructor of the PushRelabelSolver class
+     * @details Complexity: O(V), where V is the number of vertices in the graph.
+     * @param graph Graph over which the flow is computed
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     */
+    PushRelabelSolver(const FlowGraph &graph, unsigned numThreads);
+
+    /**
+     * @brief Increases a flow from the source to the sink of the graph until it is maximum
+     * @details The flow given must respect the capacities and be conserved in every vertex but the source and the
+     * sink (like a zero flow, or a flow of FlowSolver). Complexity: O(V^2*E) in the worst case, where V is the number
+     * of vertices and E the number of arcs in the graph, spread over the threads.
+     * @param flows Vector with the flows, indexed by arc, which will hold the max flow
+     * @param blocked Vector indexed by arc, non-zero for the arcs that cannot be used
+     * @return Value of the flow added
+     */
+    double solve(std::vector<double> &flows, const std::vector<char> &blocked);
+
+private:
+    /**
+     * @brief Pushes the excess of an active vertex to its neighbours with a label one below its own
+     * @param v Index of the vertex
+     * @param worker Index of the worker that discharges the vertex
+     */
+    void discharge(int v, unsigned worker);
+
+    /**
+     * @brief Calculates the new label of a vertex that kept excess after being discharged
+     * @param v Index of the vertex
+     * @return One more than the lowest label of the residual neighbours of the vertex (at most 2*V)
+     */
+    int calculateLabel(int v) const;
+
+    /**
+     * @brief Adds flow to an arc in one of the directions, updating its reverse
+     * @param arc Index of the arc
+     * @param direct True if the flow goes in the direction of the arc, false otherwise
+     * @param value Value of the flow to add
+     */
+    void pushFlow(int arc, bool direct, double value);
+
+    /**
+     * @brief Sets the labels to the distances to the sink in the residual graph, or to V plus the distances to the
+     * source for the vertices that cannot reach the sink
+     * @details Complexity: O(V+E), where V is the number of vertices and E the number of arcs in the graph.
+     */
+    void globalRelabel();
+
+    /**
+     * @brief Labels the vertices that can reach a vertex in the residual graph, with a BFS backwards from it
+     * @param root Index of the vertex, whose label must already be set
+     */
+    void labelBackwards(int root);
+
+    /**
+     * @brief Runs a function over the active vertices, in several threads if there are enough of them
+     * @param function Function called with each active vertex and the index of the worker
+     */
+    template<class F>
+    void forEachActive(const F &function);
+
+    const FlowGraph &graph;
+    std::vector<double> *flows;
+    const std::vector<char> *blocked;
+    TaskScheduler scheduler;
+
+    std::vector<int> labels;
+    std::vector<int> newLabels;
+    std::vector<double> excesses;
+    std::vector<std::atomic<double>> incoming;
+    std::vector<int> active;
+    std::vector<char> inActive;
+    std::vector<std::vector<int>> workerReceivers;
+    std::vector<int> queue;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_PUSHRELABELSOLVER_H
@@ -0,0 +1,187 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_REPORTWRITER_H
+#define DA_WATERSUPPLYMANAGEMENT_REPORTWRITER_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <fstream>
+#include <cstdint>
+
+/**
+ * @brief Formats in which the reports can be written
+ */
+enum ReportFormat {
+    REPORT_TEXT,
+    REPORT_CSV,
+    REPORT_JSONL,
+    REPORT_BINARY
+};
+
+/**
+ * @brief Value of a cell in a report, which is either a number or a text
+ */
+struct ReportValue {
+    /**
+     * @brief Constructor of a numeric value
+     * @param number Value of the cell
+     */
+    ReportValue(double number);
+
+    /**
+     * @brief Constructor of a text value
+     * @param text Value of the cell
+     */
+    ReportValue(const std::string &text);
+
+    /**
+     * @brief Constructor of a text value
+     * @param text Value of the cell
+     */
+    ReportValue(const char *text);
+
+    bool isNumber;
+    double number;
+    std::string text;
+};
+
+/**
+ * @brief Class that writes reports to a file, keeping the file open and buffering the output
+ * @details A report is made of sections, each with a title, a fixed set of columns and any number of rows. The output
+ * is accumulated in memory and only written to the file in large chunks (or when flushed), so producing many small
+ * sections does not open, write and close the file each time. The formats are:
+ * - Text: the title after "===>  " and the rows with the values separated by commas;
+ * - CSV: a header with the columns, and the rows, all prefixed by a "section" column with the title;
+ * - JSON Lines: one object per row, with the title in the "section" field and one field per column;
+ * - Binary: the magic "WSNR" and then one block per section, stored by column: the title, the number of columns and of
+ * rows, and for each column its name, its type (0 for numbers, 1 for texts) and its values. Numbers are 8-byte doubles,
+ * counts are 4-byte unsigned integers and texts are a count followed by the bytes, all in the byte order of the host.
+ */
+class ReportWriter {
+public:
+    /**
+     * @brief Constructor of the ReportWriter class, with no file open
+     */
+    ReportWriter();
+
+    /**
+     * @brief Destructor of the ReportWriter class, closes the file (writing what is still buffered)
+     */
+    ~ReportWriter();
+
+    /**
+     * @brief Opens the file to which the reports are written, closing the previous one
+     * @details The file is truncated the first time it is opened by this writer, and appended to afterwards, so
+     * switching back to a format keeps the reports already written in its file.
+     * @param path Path to the file
+     * @param format Format of the reports
+     * @return True if the file was opened, false otherwise
+     */
+    bool open(const std::string &path, ReportFormat format);
+
+    /**
+     * @brief Writes what is still buffered and closes the file
+     */
+    void close();
+
+    /**
+     * @brief Writes what is buffered to the file
+     */
+    void flush();
+
+    /**
+     * @brief Checks if there is a file open
+     * @return True if there is a file open, false otherwise
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Returns the format of the reports
+     * @return Format of the reports
+     */
+    ReportFormat getFormat() const;
+
+    /**
+     * @brief Starts a new section, ending the previous one if needed
+     * @param title Title of the section
+     * @param columns Names of the columns of the section
+     */
+    void beginSection(const std::string &title, const std::vector<std::string> &columns);
+
+    /**
+     * @brief Writes a row of the current section
+     * @details Complexity: O(n), where n is the size of the values of the row.
+     * @param values Values of the row, one for each column
+     */
+    void writeRow(const std::vector<ReportValue> &values);
+
+    /**
+     * @brief Ends the current section
+     * @details In the binary format, this is when the section is written to the buffer. Complexity: O(n), where n is
+     * the size of the values of the section.
+     */
+    void endSection();
+
+    /**
+     * @brief Returns the extension usually given to the files of a format
+     * @param format Format of the reports
+     * @return Extension of the files, with the dot
+     */
+    static std::string getExtension(ReportFormat format);
+
+    /**
+     * @brief Returns the name of a format
+     * @param format Format of the reports
+     * @return Name of the format
+     */
+    static std::string getFormatName(ReportFormat format);
+
+private:
+    /**
+     * @brief Appends a number to the buffer, in the same notation as a standard output stream
+     * @param number Number to append
+     */
+    void appendNumber(double number);
+
+    /**
+     * @brief Appends a text to the buffer, quoted as a CSV field if needed
+     * @param text Text to append
+     */
+    void appendCsv(const std::string &text);
+
+    /**
+     * @brief Appends a text to the buffer as a JSON string
+     * @param text Text to append
+     */
+    void appendJson(const std::string &text);
+
+    /**
+     * @brief Appends the raw bytes of a value to the buffer
+     * @param data Pointer to the value
+     * @param size Number of bytes
+     */
+    void appendBytes(const void *data, size_t size);
+
+    /**
+     * @brief Appends a text to the buffer, preceded by its length, as in the binary format
+     * @param text Text to append
+     */
+    void appendBinary(const std::string &text);
+
+    /**
+     * @brief Writes the buffer to the file if it has at least the size of a chunk
+     */
+    void flushIfFull();
+
+    std::ofstream output;
+    ReportFormat format;
+    std::string buffer;
+
+    bool inSection;
+    std::string title;
+    std::vector<std::string> columns;
+    std::vector<std::vector<ReportValue>> columnValues;
+
+    std::set<std::string> openedPaths;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_REPORTWRITER_H
@@ -38,7 +38,7 @@ public:
 
     /**
      * @brief Returns the current delivery of the water reservoir
-     * @details Complexity: O(E), where E is the number of outgoing pipes from the reservoir
+     * @details The delivery is the total flow of the outgoing pipes, which is kept as the flows change. Complexity: O(1).
      * @return Double representing the net delivery of the water reservoir in m^3/sec (i.e., total flow leaving the pipe [outgoing pipes])
      */
     double getDelivery() const;
@@ -0,0 +1,162 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_SCENARIORESULTSTORE_H
+#define DA_WATERSUPPLYMANAGEMENT_SCENARIORESULTSTORE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include "DeliverySite.h"
+
+/**
+ * @brief Class that stores the supply of every city in many scenarios, as one dense column per city
+ * @details The columns are ordered by the id of the cities, and each scenario is a row with a name. Rows can be appended
+ * from several threads at once, or reserved beforehand and then filled by the threads in any order. The store can be
+ * saved to a compressed columnar file: each column is stored as the XOR of its values with the baseline supply of the
+ * city, with the runs of zeros (the scenarios that do not affect the city) encoded by their length.
+ */
+class ScenarioResultStore {
+public:
+    /**
+     * @brief Constructor of the ScenarioResultStore class, with no cities
+     */
+    ScenarioResultStore();
+
+    /**
+     * @brief Sets the cities of the store, clearing all the scenarios
+     * @details Complexity: O(n*log(n)), where n is the number of cities.
+     * @param cities Vector with the cities
+     */
+    void setCities(const std::vector<DeliverySite *> &cities);
+
+    /**
+     * @brief Returns the number of cities (columns) in the store
+     * @return Number of cities
+     */
+    int getNumCities() const;
+
+    /**
+     * @brief Returns the number of scenarios (rows) in the store
+     * @return Number of scenarios
+     */
+    size_t getNumScenarios() const;
+
+    /**
+     * @brief Returns the column of a city
+     * @details Complexity: O(1).
+     * @param cityId Id of the city
+     * @return Index of the column, or -1 if the city is not in the store
+     */
+    int getColumn(int cityId) const;
+
+    /**
+     * @brief Returns the id of the city of a column
+     * @param column Index of the column
+     * @return Id of the city
+     */
+    int getCityId(int column) const;
+
+    /**
+     * @brief Returns the code of the city of a column
+     * @param column Index of the column
+     * @return Constant reference to the code of the city
+     */
+    const std::string &getCityCode(int column) const;
+
+    /**
+     * @brief Sets the supply of the cities without any scenario
+     * @param supplies Vector with the supplies, indexed by column
+     */
+    void setBaseline(const std::vector<double> &supplies);
+
+    /**
+     * @brief Returns the supply of the cities without any scenario
+     * @return Constant reference to the vector with the supplies, indexed by column
+     */
+    const std::vector<double> &getBaseline() const;
+
+    /**
+     * @brief Appends a scenario to the store, safely from any thread
+     * @details Complexity: O(n) amortized, where n is the number of cities.
+     * @param name Name of the scenario
+     * @param supplies Vector with the supplies in the scenario, indexed by column
+     * @return Index of the row of the scenario
+     */
+    size_t appendScenario(const std::string &name, const std::vector<double> &supplies);
+
+    /**
+     * @brief Reserves rows for some scenarios at the end of the store, to be filled with setScenario
+     * @details Complexity: O(n*m), where n is the number of cities and m the number of rows.
+     * @param count Number of rows to reserve
+     * @return Index of the first reserved row
+     */
+    size_t reserveScenarios(size_t count);
+
+    /**
+     * @brief Fills a reserved row
+     * @details Different rows can be filled by different threads at the same time, as long as no scenario is being
+     * appended or reserved meanwhile. Complexity: O(n), where n is the number of cities.
+     * @param row Index of the row
+     * @param name Name of the scenario
+     * @param supplies Vector with the supplies in the scenario, indexed by column
+     */
+    void setScenario(size_t row, const std::string &name, const std::vector<double> &supplies);
+
+    /**
+     * @brief Returns the name of a scenario
+     * @param row Index of the row of the scenario
+     * @return Constant reference to the name of the scenario
+     */
+    const std::string &getScenarioName(size_t row) const;
+
+    /**
+     * @brief Returns the supply of a city in a scenario
+     * @param row Index of the row of the scenario
+     * @param column Index of the column of the city
+     * @return Supply of the city in the scenario
+     */
+    double getSupply(size_t row, int column) const;
+
+    /**
+     * @brief Returns the supplies of a city in all the scenarios
+     * @param column Index of the column of the city
+     * @return Constant reference to the vector with the supplies, indexed by row
+     */
+    const std::vector<double> &getColumnValues(int column) const;
+
+    /**
+     * @brief Saves the store to a compressed columnar file
+     * @details The file has the magic "WSNS", the number of cities and of scenarios, the ids and codes of the cities,
+     * the baseline supplies, the names of the scenarios and then each column compressed. A compressed column is its
+     * number of blocks followed by the blocks, each with a count of zero words, a count of literal words and the literal
+     * words, where each word is the XOR of the bits of a value with the bits of the baseline supply of the city.
+     * Complexity: O(n*m), where n is the number of cities and m the number of scenarios.
+     * @param path Path to the file
+     * @return True if the file was written, false otherwise
+     */
+    bool save(const std::string &path) const;
+
+    /**
+     * @brief Loads the store from a file written by save
+     * @details Complexity: O(n*m), where n is the number of cities and m the number of scenarios.
+     * @param path Path to the file
+     * @return True if the file was read, false otherwise (in which case the store is left empty)
+     */
+    bool load(const std::string &path);
+
+private:
+    /**
+     * @brief Clears the scenarios and resizes the columns for the cities
+     */
+    void resetColumns();
+
+    std::vector<int> cityIds;
+    std::vector<std::string> cityCodes;
+    std::vector<int> idToColumn;
+    std::vector<double> baseline;
+
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> columns;
+    std::mutex appendMutex;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_SCENARIORESULTSTORE_H
@@ -24,6 +24,18 @@ public:
      */
     int getId() const;
 
+    /**
+     * @brief Returns the index of the service point in the network
+     * @return Index of the service point, or -1 if the service point was not indexed
+     */
+    int getIndex() const;
+
+    /**
+     * @brief Sets the index of the service point in the network
+     * @param index Index of the service point
+     */
+    void setIndex(int index);
+
     /**
      * @brief Returns the code of the service point
      * @return Code of the service point
@@ -44,6 +56,28 @@ public:
      */
     std::vector<Pipe*> getIncoming() const;
 
+    /**
+     * @brief Returns the total flow of the incoming pipes, kept up to date as the flows of the pipes change
+     * @details Complexity: O(1).
+     * @return Sum of the flows of the incoming pipes
+     */
+    double getInflow() const;
+
+    /**
+     * @brief Returns the total flow of the outgoing pipes, kept up to date as the flows of the pipes change
+     * @details Complexity: O(1).
+     * @return Sum of the flows of the outgoing pipes
+     */
+    double getOutflow() const;
+
+    /**
+     * @brief Adds to the totals of flow, when the flow of a pipe of the service point changes
+     * @details Called by Pipe::updateFlow. Complexity: O(1).
+     * @param inflowDelta Change of the flow of the incoming pipes
+     * @param outflowDelta Change of the flow of the outgoing pipes
+     */
+    void addFlow(double inflowDelta, double outflowDelta);
+
     /**
      * @brief Returns the parent's pipe that connects to this service point (auxiliary to graph searches)
      * @return Pointer to the parent's pipe to this service point
@@ -71,6 +105,12 @@ public:
      */
     Edge<std::string> *addEdge(Vertex<std::string> *dest, double w) override;
 
+    /**
+     * @brief Sorts the outgoing and incoming pipes by the id and code of the service point on the other end
+     * @details Complexity: O(n*log(n)), where n is the number of pipes of the service point.
+     */
+    void sortPipes();
+
     /**
      * @brief Returns a description of the service point
      * @details Complexity: O(1).
@@ -88,7 +128,10 @@ public:
 
 private:
     int id;
+    int index;
     bool hidden;
+    double inflow;
+    double outflow;
 };
 
 #endif //DA_WATERSUPPLYMANAGEMENT_SERVICEPOINT_H
@@ -0,0 +1,247 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_SOLVERVERIFIER_H
+#define DA_WATERSUPPLYMANAGEMENT_SOLVERVERIFIER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <random>
+#include <functional>
+#include "WaterSupplyNetwork.h"
+
+/**
+ * @brief Property of a flow that did not hold in one of the random networks
+ * @details The files of the network are kept in the directory of the verifier, with the prefix of the network, so the
+ * failure can be reproduced by loading them.
+ */
+struct VerificationFailure {
+    unsigned network;
+    std::string prefix;
+    std::string check;
+    std::string detail;
+};
+
+/**
+ * @brief Result of a verification of the solvers on random networks
+ */
+struct VerificationReport {
+    unsigned long seed;
+    unsigned numNetworks;
+    uint64_t numChecks;
+    std::vector<VerificationFailure> failures;
+};
+
+/**
+ * @brief Class that checks every max flow algorithm of the network against the others, on random networks
+ * @details Each network is generated with a few parts that do not share any pipe, written to the four files read by
+ * WaterSupplyNetwork::parseData and loaded from them. Then, its max flow is calculated by Edmonds-Karp, push relabel
+ * and the minimum cost algorithm, and the max flow without each pipe, reservoir and pumping station by the incremental
+ * and the brute-force algorithms (and by the components, for the pipes). After each calculation, the flows left in the
+ * pipes must respect their capacities, be conserved at every service point, leave the hidden pipes and service points
+ * empty, add up to the returned value and saturate a cut (so they are a max flow), and all the algorithms must agree on
+ * the value. The analyses built on the max flow are checked too: the max flow from a previous flow, the balancing, the
+ * saved failure sweeps, the worst combinations of failures against the brute force, the critical pipes of each city,
+ * the demand breakpoints and a simulation over a random time profile. The large network is big enough for Edmonds-Karp
+ * to use the parallel BFS and for push relabel to discharge its active service points in several threads, and is
+ * checked against the same solvers in one thread. Before the random networks, two sections are written in each format
+ * of the reports and read back. The files of the networks that pass every check are removed.
+ */
+class SolverVerifier {
+public:
+    /**
+     * @brief Constructor of the SolverVerifier class
+     * @param seed Seed of the random networks, so a verification can be repeated
+     * @param directory Directory where the files of the networks are written (the temporary directory if empty)
+     */
+    explicit SolverVerifier(unsigned long seed, const std::string &directory = "");
+
+    /**
+     * @brief Generates and verifies some random networks
+     * @details Complexity: O(n*P*V*E^2), where n is the number of networks, P the number of pipes and service points of
+     * a network, V the number of vertices and E the number of edges.
+     * @param numNetworks Number of networks to verify
+     * @return Report with the number of checks and the ones that failed
+     */
+    VerificationReport run(unsigned numNetworks);
+
+    /**
+     * @brief Generates and verifies a network large enough for the parallel paths of the solvers
+     * @details Complexity: O(V*E^2), where V is the number of vertices and E the number of edges of the network.
+     * @return Report with the number of checks and the ones that failed
+     */
+    VerificationReport runLarge();
+
+private:
+    /**
+     * @brief Writes the files of a random network
+     * @param prefix Path of the files without the suffix of each one
+     */
+    void generateNetwork(const std::string &prefix);
+
+    /**
+     * @brief Writes the files of a random network with layers of pumping stations between the reservoirs and the cities
+     * @param prefix Path of the files without the suffix of each one
+     */
+    void generateLargeNetwork(const std::string &prefix);
+
+    /**
+     * @brief Loads a network from its files, verifies it and removes the files if every check holds
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param verify Function that runs the checks on the network
+     * @param report Report that will hold the checks
+     */
+    void verifyFiles(unsigned network, const std::string &prefix,
+                     const std::function<void(WaterSupplyNetwork &)> &verify, VerificationReport &report);
+
+    /**
+     * @brief Runs every algorithm on a network and checks their flows
+     * @param wsn Network loaded from the files
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the checks
+     */
+    void verifyNetwork(WaterSupplyNetwork &wsn, unsigned network, const std::string &prefix, VerificationReport &report);
+
+    /**
+     * @brief Checks that two sections written through a ReportWriter in each format are read back as expected, with the
+     * file left by a previous run truncated when it is first opened and the second section appended after reopening it
+     * @param prefix Path of the files of the reports, without the suffix and the extension
+     * @param report Report that will hold the checks
+     */
+    static void verifyReports(const std::string &prefix, VerificationReport &report);
+
+    /**
+     * @brief Checks that the max flow calculated from a previous flow is the one calculated from zero, both when the
+     * previous flow no longer fits (the busiest pipe loses half of its flow) and when it is a feasible flow that is not
+     * maximum (half of the minimum cost flow)
+     * @param wsn Network loaded from the files
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the checks
+     */
+    static void verifyWarmStart(WaterSupplyNetwork &wsn, unsigned network, const std::string &prefix,
+                                VerificationReport &report);
+
+    /**
+     * @brief Checks that balancing the cached max flow keeps a max flow of the same value, within the capacities and
+     * conserved at every service point, and does not increase the variance of the differences between capacity and flow
+     * @param wsn Network loaded from the files
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the checks
+     */
+    static void verifyBalancing(WaterSupplyNetwork &wsn, unsigned network, const std::string &prefix,
+                                VerificationReport &report);
+
+    /**
+     * @brief Checks that result stores are loaded back with the values they were saved with: the failure sweep of the
+     * network, an empty store, a store without scenarios and a store whose scenarios are all the baseline
+     * @param wsn Network loaded from the files
+     * @param network Index of the network
+     * @param prefix Path of the files of the network, also used for the file of the stores
+     * @param report Report that will hold the checks
+     */
+    static void verifyResultStore(WaterSupplyNetwork &wsn, unsigned network, const std::string &prefix,
+                                  VerificationReport &report);
+
+    /**
+     * @brief Checks that the worst total flows of the N-k analyses, for k up to 3, are the ones found by hiding every
+     * combination of elements and calculating the max flow from zero
+     * @details k stops earlier in the networks with too many elements for the brute force.
+     * @param wsn Network loaded from the files
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the checks
+     */
+    static void verifyWorstFailures(WaterSupplyNetwork &wsn, unsigned network, const std::string &prefix,
+                                    VerificationReport &report);
+
+    /**
+     * @brief Checks that the critical pipes of each city do not depend on the number of threads, and include every
+     * pipe without which the city cannot get its supply
+     * @details The second check is only done for the cities that do not pass water on through unidirectional pipes,
+     * whose supply is then the water they keep.
+     * @param wsn Network loaded from the files
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the checks
+     */
+    static void verifyCriticalPipes(WaterSupplyNetwork &wsn, unsigned network, const std::string &prefix,
+                                    VerificationReport &report);
+
+    /**
+     * @brief Checks that the demand breakpoints are sorted, and that each city is fully supplied by every max flow
+     * algorithm with the demands scaled by its factor
+     * @param wsn Network loaded from the files
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the checks
+     */
+    static void verifyDemandBreakpoints(WaterSupplyNetwork &wsn, unsigned network, const std::string &prefix,
+                                        VerificationReport &report);
+
+    /**
+     * @brief Simulates the network over a random time profile, and checks that the supplies of each step add up to
+     * the max flow with the capacities of the step and that the capacities are restored at the end
+     * @param wsn Network loaded from the files
+     * @param network Index of the network
+     * @param prefix Path of the files of the network, also used for the file of the profile
+     * @param report Report that will hold the checks
+     */
+    void verifyTimeSeries(WaterSupplyNetwork &wsn, unsigned network, const std::string &prefix,
+                          VerificationReport &report);
+
+    /**
+     * @brief Checks the max flows and the demand breakpoints found in several threads against the ones found in one
+     * @param wsn Network loaded from the files
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the checks
+     */
+    static void verifyParallelSolvers(WaterSupplyNetwork &wsn, unsigned network, const std::string &prefix,
+                                      VerificationReport &report);
+
+    /**
+     * @brief Checks that the flows left in the pipes are a max flow of the network without its hidden elements
+     * @details Complexity: O(V+E), where V is the number of vertices and E the number of edges.
+     * @param wsn Network with the flows
+     * @param algorithm Name of the algorithm that left the flows, for the failures
+     * @param flow Value returned by the algorithm
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the checks
+     */
+    static void checkFlow(WaterSupplyNetwork &wsn, const std::string &algorithm, double flow, unsigned network,
+                          const std::string &prefix, VerificationReport &report);
+
+    /**
+     * @brief Counts a check, and adds a failure to the report if it did not hold
+     * @param holds Whether the check holds
+     * @param check Name of the check
+     * @param detail Description of what did not hold
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the check
+     */
+    static void expect(bool holds, const std::string &check, const std::string &detail, unsigned network,
+                       const std::string &prefix, VerificationReport &report);
+
+    /**
+     * @brief Checks that two algorithms found the same total, within the tolerance of the network
+     * @param algorithm Name of the algorithm checked
+     * @param value Total found by the algorithm
+     * @param reference Name of the algorithm that found the expected total
+     * @param expected Expected total
+     * @param network Index of the network
+     * @param prefix Path of the files of the network
+     * @param report Report that will hold the check
+     */
+    static void agree(const std::string &algorithm, double value, const std::string &reference, double expected,
+                      unsigned network, const std::string &prefix, VerificationReport &report);
+
+    unsigned long seed;
+    std::string directory;
+    std::mt19937 random;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_SOLVERVERIFIER_H
@@ -0,0 +1,41 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_STATIONOUTLET_H
+#define DA_WATERSUPPLYMANAGEMENT_STATIONOUTLET_H
+
+#include "ServicePoint.h"
+#include <string>
+
+class PumpingStation;
+
+/**
+ * @brief Class representation of the outlet of a pumping station with a limited throughput
+ * @details The station is split in two vertices: the station itself receives the incoming pipes, the outlet holds the
+ * outgoing pipes, and a pipe from the station to the outlet, with the throughput of the station as capacity, carries
+ * all the water pumped. This way every max flow algorithm respects the limit of the station without knowing about it.
+ */
+class StationOutlet : public ServicePoint {
+public:
+    /**
+     * @brief Constructor of the StationOutlet class
+     * @details The outlet has the id of the station and its code followed by "_out".
+     * @param station Pumping station of the outlet
+     */
+    explicit StationOutlet(PumpingStation *station);
+
+    /**
+     * @brief Returns a description of the outlet
+     * @details Complexity: O(1).
+     * @return String with a description (code) of the pumping station of the outlet
+     */
+    std::string getDescription() const;
+
+    /**
+     * @brief Returns the pumping station of the outlet
+     * @return Pointer to the pumping station
+     */
+    PumpingStation *getStation() const;
+
+private:
+    PumpingStation *station;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_STATIONOUTLET_H
@@ -0,0 +1,116 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_TASKSCHEDULER_H
+#define DA_WATERSUPPLYMANAGEMENT_TASKSCHEDULER_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+/**
+ * @brief Class that runs batches of independent tasks on several worker threads, balancing them with work stealing
+ * @details The tasks of a batch are numbered, and are first split in equal contiguous blocks, one for each worker. Each
+ * worker has a lock-free deque (Chase-Lev) with its block: it takes its own tasks from the bottom, in increasing order,
+ * and when its deque is empty it steals tasks from the top of the deques of the other workers, so that workers with
+ * cheap tasks help the ones with expensive tasks. The tasks receive the index of the worker that runs them, so that
+ * each worker can keep its own scratch memory (like a FlowSolver). The worker threads are started once, by the
+ * constructor, and sleep on a condition variable between batches, so that callers with many small batches (like the
+ * levels of a ParallelBfs or the rounds of a PushRelabelSolver) do not pay for starting threads on each one.
+ */
+class TaskScheduler {
+public:
+    /**
+     * @brief Constructor of the TaskScheduler class
+     * @param numWorkers Number of worker threads (0 to use the number of hardware threads)
+     */
+    explicit TaskScheduler(unsigned numWorkers = 0);
+
+    /**
+     * @brief Destructor of the TaskScheduler class, stops and joins the worker threads
+     */
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    /**
+     * @brief Returns the number of workers
+     * @return Number of worker threads, which is the bound of the worker indexes given to the tasks
+     */
+    unsigned getNumWorkers() const;
+
+    /**
+     * @brief Runs a batch of tasks and waits for all of them to finish
+     * @details The calling thread is used as worker 0. Complexity: O(n/w + w) besides the tasks, where n is the number
+     * of tasks and w the number of workers.
+     * @param numTasks Number of tasks, numbered from 0 to numTasks-1
+     * @param task Function called once for each task, with the number of the task and the index of the worker
+     */
+    void run(size_t numTasks, const std::function<void(size_t task, unsigned worker)> &task);
+
+private:
+    /**
+     * @brief Deque of tasks of a worker, filled before the batch starts
+     */
+    class WorkDeque {
+    public:
+        WorkDeque();
+
+        /**
+         * @brief Fills the deque with a block of tasks, so that the first task is at the bottom
+         * @param first First task of the block
+         * @param last Task after the last task of the block
+         */
+        void reset(size_t first, size_t last);
+
+        /**
+         * @brief Takes the task at the bottom of the deque, only from the worker that owns it
+         * @param task Variable that will hold the task
+         * @return True if a task was taken, false if the deque is empty
+         */
+        bool pop(size_t &task);
+
+        /**
+         * @brief Takes the task at the top of the deque, from any other worker
+         * @param task Variable that will hold the task
+         * @return True if a task was taken, false if the deque is empty or another worker took the task first
+         */
+        bool steal(size_t &task);
+
+    private:
+        std::vector<size_t> tasks;
+        std::atomic<long> top;
+        std::atomic<long> bottom;
+    };
+
+    /**
+     * @brief Loop of a worker, which runs its own tasks and then steals from the others until none are left
+     * @param worker Index of the worker
+     * @param task Function to call for each task
+     */
+    void work(unsigned worker, const std::function<void(size_t, unsigned)> &task);
+
+    /**
+     * @brief Loop of a worker thread, which waits for each batch, works on it and reports that it is done
+     * @param worker Index of the worker
+     */
+    void serve(unsigned worker);
+
+    unsigned numWorkers;
+    std::vector<std::unique_ptr<WorkDeque>> deques;
+    std::atomic<size_t> remaining;
+
+    std::vector<std::thread> threads;
+    std::mutex batchMutex;
+    std::condition_variable batchReady;
+    std::condition_variable batchDone;
+    const std::function<void(size_t, unsigned)> *batchTask;
+    unsigned long batch;
+    unsigned busyWorkers;
+    bool stopping;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_TASKSCHEDULER_H
@@ -0,0 +1,74 @@
+#ifndef DA_WATERSUPPLYMANAGEMENT_TIMEPROFILE_H
+#define DA_WATERSUPPLYMANAGEMENT_TIMEPROFILE_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Class that holds the values of some service points over a sequence of time steps
+ * @details The values are the demands of cities or the maximum deliveries of reservoirs, one row for each service
+ * point. The file of a profile is a CSV with a header "Code" followed by the names of the steps (like the hours of a
+ * day or of a year), and then one line for each service point, with its code and its value in every step.
+ */
+class TimeProfile {
+public:
+    /**
+     * @brief Constructor of the TimeProfile class, with no steps and no service points
+     */
+    TimeProfile();
+
+    /**
+     * @brief Loads a profile from a CSV file, replacing the current one
+     * @details Complexity: O(n*m), where n is the number of service points and m the number of steps.
+     * @param path Path to the file
+     * @return True if the file was read, false if it could not be opened or a line does not have a valid value (a
+     * number that is not negative) for every step, in which case the profile is left empty
+     */
+    bool load(const std::string &path);
+
+    /**
+     * @brief Returns the number of time steps
+     * @return Number of steps
+     */
+    size_t getNumSteps() const;
+
+    /**
+     * @brief Returns the name of a time step
+     * @param step Index of the step
+     * @return Constant reference to the name of the step
+     */
+    const std::string &getStepName(size_t step) const;
+
+    /**
+     * @brief Returns the number of service points (rows) in the profile
+     * @return Number of service points
+     */
+    size_t getNumRows() const;
+
+    /**
+     * @brief Returns the code of the service point of a row
+     * @param row Index of the row
+     * @return Constant reference to the code of the service point
+     */
+    const std::string &getCode(size_t row) const;
+
+    /**
+     * @brief Returns the value of a service point in a time step
+     * @param row Index of the row of the service point
+     * @param step Index of the step
+     * @return Value of the service point in the step
+     */
+    double getValue(size_t row, size_t step) const;
+
+private:
+    /**
+     * @brief Clears the steps and the service points
+     */
+    void clear();
+
+    std::vector<std::string> stepNames;
+    std::vector<std::string> codes;
+    std::vector<std::vector<double>> values;
+};
+
+#endif //DA_WATERSUPPLYMANAGEMENT_TIMEPROFILE_H
@@ -4,12 +4,30 @@
 #include <string>
 #include <queue>
 #include <stack>
+#include <functional>
 #include "Graph.h"
 #include "ServicePoint.h"
 #include "Reservoir.h"
 #include "PumpingStation.h"
 #include "DeliverySite.h"
-#include "AugmentingPath.h"
+#include "AugmentingPathPool.h"
+#include "FlowGraph.h"
+#include "FailureScenarioEngine.h"
+#include "BalancingEngine.h"
+#include "MinCostFlowSolver.h"
+#include "MetricsAccumulator.h"
+#include "ParallelBfs.h"
+#include "PushRelabelSolver.h"
+#include "TimeProfile.h"
+#include "NetworkDecomposition.h"
+
+/**
+ * @brief Algorithms with which the max flow of the network can be calculated
+ */
+enum MaxFlowAlgorithm {
+    MAX_FLOW_EDMONDS_KARP,
+    MAX_FLOW_PUSH_RELABEL
+};
 
 /**
  * @brief Class representation of a water supply network
@@ -100,7 +118,9 @@ public:
 
     /**
      * @brief Finds a pipe given its source and destination codes
-     * @details Complexity: O(n), where n is the number of outgoing edges of the source vertex (service point)
+     * @details The pipes that leave a pumping station with a throughput limit are searched in its outlet when they
+     * are not found in the station. Complexity: O(n), where n is the number of outgoing edges of the source vertex
+     * (service point)
      * @param src Code of the source service point
      * @param dest Code of the destination service point
      * @return Pointer to the found service pipe if it exists, or nullptr otherwise
@@ -108,26 +128,86 @@ public:
     Pipe *findPipe(const std::string &src, const std::string &dest);
 
     /**
-     * @brief Function to calculate the max flow of the network, using the Edmonds Karp algorithm
-     * @details Complexity: O(V*E^2), where V is the number of vertices in the graph and E the number of edges.
+     * @brief Function to calculate the max flow of the network, using the Edmonds Karp algorithm or push relabel
+     * @details Push relabel (see PushRelabelSolver) runs in several threads, and is meant for single very large
+     * networks. It finds no augmenting paths, so Edmonds Karp is always used when they are saved.
+     * Complexity: O(V*E^2) with Edmonds Karp and O(V^2*E) with push relabel, where V is the number of vertices in the
+     * graph and E the number of edges.
      * @param saveAugmentingPaths Whether the function should save the augmenting paths found or not
+     * @param algorithm Algorithm used to calculate the max flow
      * @return The value of the max flow
      */
-    double getMaxFlow(bool saveAugmentingPaths = false);
+    double getMaxFlow(bool saveAugmentingPaths = false, MaxFlowAlgorithm algorithm = MAX_FLOW_EDMONDS_KARP);
 
     /**
-     * @brief Loads the max flow cached in an auxiliary network, or calculates it and stores it if not previously ran
-     * @details Complexity: O(D) if cached, O(V*E^2) if not cached, where D is the number of delivery sites, V is the
+     * @brief Function to calculate the max flow of the network starting from a previous flow, instead of from zero
+     * @details The flow given is first made feasible: the flow of each pipe is clamped to its capacity (and to zero in
+     * the direction of a hidden pipe), and then the excess left in each service point is pushed back towards the supersource, and the
+     * missing flow is removed towards the supersink, through the pipes with flow. The result is then augmented with the
+     * Edmonds Karp algorithm, so when the network changed little since the flow was calculated, only a few augmenting
+     * paths are needed. The augmenting paths are not saved. Complexity: O(V*E^2) in the worst case, where V is the
      * number of vertices in the graph and E the number of edges.
+     * @param flows Vector with the previous flows, indexed by pipe (see getPipeFlows)
+     * @return The value of the max flow
+     */
+    double getMaxFlowFrom(const std::vector<double> &flows);
+
+    /**
+     * @brief Returns the current flows of the pipes
+     * @details Complexity: O(E), where E is the number of edges in the graph.
+     * @return Vector with the flows, indexed by pipe
+     */
+    std::vector<double> getPipeFlows() const;
+
+    /**
+     * @brief Loads the max flow cached in an auxiliary network, or calculates it and stores it if the cache is outdated
+     * @details The cache is outdated when the version of the network changed since it was calculated. If only capacities
+     * changed, the cached flow is updated incrementally (see updateCachedMaxFlow), otherwise it is calculated from
+     * scratch. Complexity: O(E) if cached, O(V*E^2) if outdated, where V is the number of vertices in the graph and E
+     * the number of edges.
      * @return The value of the max flow
      */
     double loadCachedMaxFlow();
 
+    /**
+     * @brief Calculates a max flow of the network with the minimum pumping cost
+     * @details The cost of a unit of flow through a pipe is the cost of the pipe plus the pumping cost of its
+     * destination, if it is a pumping station (see MinCostFlowSolver). The total flow is the same as the one of
+     * getMaxFlow, and the flow is left in the network, without changing the cached max flow. Complexity: O(F*E*log(V)),
+     * where F is the number of augmenting paths, V the number of vertices in the graph and E the number of edges.
+     * @param cost Variable that will hold the total cost of the flow
+     * @return The value of the max flow
+     */
+    double getMinCostMaxFlow(double &cost);
+
+    /**
+     * @brief Marks the cached max flow as outdated, so that it is calculated from scratch when it is next loaded
+     * @details Complexity: O(1).
+     */
+    void invalidateCachedMaxFlow();
+
+    /**
+     * @brief Returns the version of the network, which changes on every change of the topology or of the capacities
+     * @details Complexity: O(1).
+     * @return Version of the network
+     */
+    unsigned long getVersion() const;
+
+    /**
+     * @brief Changes the capacity of a pipe, updating the version of the network
+     * @details The other direction of a bidirectional pipe (its reverse, or its twin if it was split) gets the same
+     * capacity, and the version is updated once. Complexity: O(1).
+     * @param pipe Pointer to the pipe
+     * @param capacity New capacity of the pipe
+     */
+    void setPipeCapacity(Pipe *pipe, double capacity);
+
     /**
      * @brief Function to calculate the max flow without some of the pipes
      * @details It uses an optimized algorithm that reuses the previously calculated value of the max flow that tries to
-     * remove the flows of augmenting paths to not run the Edmonds Karp from scratch again. Complexity: O(V*E^2), where
-     * V is the number of vertices in the graph and E the number of edges.
+     * remove the flows of augmenting paths to not run the Edmonds Karp from scratch again. Only the augmenting paths that
+     * pass through the pipes (found through the pipe index of the decomposition) are removed. Complexity: O(V*E^2),
+     * where V is the number of vertices in the graph and E the number of edges.
      * @param pipes Vector of the pipes that shouldn't be considered
      * @return The max flow of the entire network
      */
@@ -135,7 +215,10 @@ public:
 
     /**
      * @brief Function to calculate the max flow without one of the reservoirs (optimized)
-     * @details Complexity: O(V*E^2), where V is the number of vertices in the graph and E the number of edges.
+     * @details The pipes of the reservoir are removed in both directions, so, as in getMaxFlowWithoutReservoirBF, no
+     * water passes through it either. A reservoir outage (see sweepReservoirOutages) only limits the pipe from the
+     * supersource instead, and can deliver more when other service points send water through the bidirectional pipes of
+     * the reservoir. Complexity: O(V*E^2), where V is the number of vertices in the graph and E the number of edges.
      * @param reservoir Reservoir that shouldn't be considered
      * @return The max flow of the entire network
      */
@@ -173,13 +256,179 @@ public:
      */
     double getMaxFlowWithoutStationBF(PumpingStation* station);
 
+    /**
+     * @brief Function to calculate the max flow without some of the pipes, solving again only the parts of the network
+     * that contain them
+     * @details The network is split in components that do not share any pipe (see NetworkDecomposition), so the flows
+     * of the cached max flow in the other components stay valid and only the components of the pipes are solved from
+     * zero, in parallel. Complexity: O(V^2*E) for each affected component, where V is the number of vertices and E the
+     * number of edges of the component.
+     * @param pipes Vector of the pipes that shouldn't be considered
+     * @return The max flow of the entire network
+     */
+    double getMaxFlowWithoutPipesInComponents(const std::vector<Pipe*> &pipes);
+
+    /**
+     * @brief Returns the number of parts of the network that do not share any pipe
+     * @return Number of components of the network
+     */
+    int getNumComponents() const;
+
+    /**
+     * @brief Returns the component of a service point
+     * @param servicePoint Service point of the network
+     * @return Index of the component of the service point
+     */
+    int getComponent(const ServicePoint *servicePoint) const;
+
+    /**
+     * @brief Function to calculate the flow that reaches the cities of each component in the max flow
+     * @details Complexity: O(E), where E is the number of edges, after the cached max flow is loaded.
+     * @return Vector with the flow of each component
+     */
+    std::vector<double> getComponentFlows();
+
+    /**
+     * @brief Returns the service points whose removal splits their component of the network
+     * @details A pumping station is returned instead of its outlet. Complexity: O(V), where V is the number of service
+     * points.
+     * @return Vector with the articulation points, in the order of their indexes
+     */
+    std::vector<ServicePoint*> getArticulationPoints() const;
+
+    /**
+     * @brief Returns the pipes whose failure splits their component of the network
+     * @details Only one of the two pipes of a bidirectional pipe is returned, and the pipes from a pumping station to
+     * its outlet are not. Complexity: O(E), where E is the number of edges.
+     * @return Vector with the bridges, in the order of their indexes
+     */
+    std::vector<Pipe*> getBridgePipes() const;
+
+    /**
+     * @brief Calls a function for each element of the network that can fail
+     * @details The elements are the pipes between two service points, with both directions of a bidirectional pipe
+     * counted once, in the order of their indexes, and then the reservoirs and pumping stations, in the order of their
+     * ids. Complexity: O(V+E), where V is the number of vertices and E the number of edges.
+     * @param pipeFunction Function called with each pipe
+     * @param reservoirFunction Function called with each reservoir
+     * @param stationFunction Function called with each pumping station
+     */
+    void forEachFailureElement(const std::function<void(Pipe*)> &pipeFunction,
+                               const std::function<void(Reservoir*)> &reservoirFunction,
+                               const std::function<void(PumpingStation*)> &stationFunction) const;
+
+    /**
+     * @brief Returns the description of a pipe as an element that can fail
+     * @param pipe Pointer to the pipe
+     * @return Codes of the ends of the pipe, joined by "<->" if it is bidirectional and by "->" otherwise
+     */
+    static std::string getPipeDescription(const Pipe *pipe);
+
+    /**
+     * @brief Returns the largest difference between two values of max flows computed in different ways for them to be
+     * considered equal
+     * @details The tolerance is relative to the flow, or absolute for flows below 1, since the values are sums of many
+     * pipes and the algorithms add them in different orders.
+     * @param flow One of the values
+     * @return Tolerance for the value
+     */
+    static double getFlowTolerance(double flow);
+
     /**
      * @brief Function to obtain the critical pipes for a given city
-     * @details Complexity: O(V*E^2), where V is the number of vertices in the graph and E the number of edges.
+     * @details The candidates are the pipes of the augmenting paths that reach the city. A bridge that leaves a
+     * supplied city without any reservoir is critical (see NetworkDecomposition), which is what its repair would find.
+     * The failure of each remaining candidate is repaired in parallel (see FailureScenarioEngine), and the pipe is
+     * critical if the city gets less water in the repaired flow.
+     * Complexity: O(P*V*E^2), where P is the number of candidates, V is the number of vertices in the graph and E the
+     * number of edges.
      * @param city Pointer to the city to be considered for the critical pipes
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
      * @return Vector containing pointers to all the pipes that are critical for the given city
      */
-    std::vector<Pipe*> getCriticalPipesToCity(DeliverySite *city);
+    std::vector<Pipe*> getCriticalPipesToCity(DeliverySite *city, unsigned numThreads = 0);
+
+    /**
+     * @brief Function to find the worst combinations of up to k simultaneous failures of pipes, pumping stations and
+     * reservoirs, for the whole network and for each city
+     * @details The combinations are evaluated in parallel by repairing the cached max flow, and the combinations that
+     * cannot change its total are pruned (see FailureScenarioEngine for the supplies of the cities). Complexity: O(C(n,k)*k + S*V*E^2), where n is the number of
+     * elements, S the number of combinations that are not pruned, V the number of vertices and E the number of edges.
+     * @param k Maximum number of simultaneous failures
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     * @return Report with the worst combinations of failures
+     */
+    FailureReport getWorstFailures(int k, unsigned numThreads = 0);
+
+    /**
+     * @brief Function to evaluate the failure of each pipe, pumping station and reservoir alone, storing the supply of
+     * every city in each failure
+     * @details The store is reset with the delivery sites of the network and the cached max flow as the baseline. The
+     * failures are evaluated in parallel by repairing the cached max flow. Complexity: O(n*V*E^2), where n is the number
+     * of elements that can fail, V the number of vertices and E the number of edges.
+     * @param store Store where the results are saved, one scenario per failure
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     */
+    void sweepFailures(ScenarioResultStore &store, unsigned numThreads = 0);
+
+    /**
+     * @brief Function to evaluate the outage of each reservoir alone, or a drought that reduces its delivery, storing
+     * the supply of every city in each one
+     * @details A reservoir outage limits the capacity of its pipe from the supersource, instead of hiding the reservoir,
+     * and the cached max flow is repaired for it (see FailureScenarioEngine), with the reservoirs evaluated in
+     * parallel. The store is reset with the delivery sites of the network and the cached max flow as the baseline, and
+     * has one scenario per reservoir, named with its code. Complexity: O(R*V*E^2), where R is the number of
+     * reservoirs, V the number of vertices and E the number of edges.
+     * @param store Store where the results are saved, one scenario per reservoir
+     * @param capacityFactor Fraction of the maximum delivery that each reservoir keeps (0 for an outage)
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     */
+    void sweepReservoirOutages(ScenarioResultStore &store, double capacityFactor = 0, unsigned numThreads = 0);
+
+    /**
+     * @brief Function to evaluate the partial degradation of each pumping station alone, storing the supply of every
+     * city in each one
+     * @details A degraded station keeps a fraction of its throughput limit, or of the capacity of each of its outgoing
+     * pipes if it has no limit, and the cached max flow is repaired for it (see FailureScenarioEngine), with the
+     * stations evaluated in parallel. The store is reset with the delivery sites of the network and the cached max
+     * flow as the baseline, and has one scenario per station, named with its code. Complexity: O(S*V*E^2), where S is
+     * the number of stations, V the number of vertices and E the number of edges.
+     * @param store Store where the results are saved, one scenario per station
+     * @param capacityFactor Fraction of the capacity that each station keeps (0 for an outage)
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     */
+    void sweepStationDegradations(ScenarioResultStore &store, double capacityFactor, unsigned numThreads = 0);
+
+    /**
+     * @brief Function to simulate the network over a sequence of time steps, storing the supply of every city in each
+     * step
+     * @details In each step, the demands of the cities and the maximum deliveries of the reservoirs in the profile are
+     * set as the capacities of their pipes to the supersink and from the supersource (the others keep their values),
+     * and the max flow of the previous step is repaired for the new capacities (see updateCachedMaxFlow) instead of
+     * calculated from zero. The store is reset with the delivery sites of the network and the cached max flow as the
+     * baseline, and the capacities are restored at the end. Complexity: O(m*(E + R)), where m is the number of steps, E
+     * the number of edges and R the cost of repairing the flow, usually much lower than a full max flow.
+     * @param profile Profile with the demands of the cities and the maximum deliveries of the reservoirs
+     * @param store Store where the results are saved, one scenario per step
+     * @return True if the simulation was done, false if the profile has a code that is not of a city or a reservoir
+     */
+    bool simulateTimeSeries(const TimeProfile &profile, ScenarioResultStore &store);
+
+    /**
+     * @brief Function to find, for each city, how much the demands of all cities can grow uniformly before the city is
+     * no longer sure to be fully supplied
+     * @details With the demands scaled by a factor, a city is sure to be fully supplied if its demand is met by every
+     * max flow, which happens when it cannot reach the supersink in the residual graph of a max flow. The set of such
+     * cities only shrinks as the factor grows (parametric max flow), so the breakpoints are found together by
+     * bisecting the intervals between evaluated factors in which some city changes, each evaluation warm-started from
+     * the max flow of the factor below it (see getMaxFlowFrom). The demands are restored at the end.
+     * Complexity: O(n*log(1/t)*F), where n is the number of cities, t the tolerance and F the cost of a warm-started max
+     * flow.
+     * @param tolerance Relative precision of the factors found
+     * @return Vector with each city and the largest factor found for which it is sure to be fully supplied (infinity
+     * for cities without demand), sorted by factor; the first factor is the saturation point of the network
+     */
+    std::vector<std::pair<DeliverySite*, double>> getDemandBreakpoints(double tolerance = 1e-4);
 
     /**
      * @brief Marks all service points as not hidden
@@ -236,27 +485,51 @@ public:
     void unhidePipe(Pipe *pipe);
 
     /**
-     * @brief Marks as hidden the pipes with negative flows or to the supersource/supersink and calculates metrics
-     * @details Complexity: O(V*E), where V is the number of service points, and E is the number of adjacent pipes.
+     * @brief Fills an accumulator with the differences between capacity and flow of the pipes, keyed by pipe index
+     * @details The pipes of the supersource/supersink are skipped, and each bidirectional pipe is counted once, in the
+     * direction of its flow. The accumulator can then be updated as the flows of single pipes change, and also gives
+     * quantiles of the differences. Complexity: O(E), where E is the number of pipes.
+     * @param accumulator Accumulator that will hold the differences
+     */
+    void accumulateMetrics(MetricsAccumulator &accumulator) const;
+
+    /**
+     * @brief Calculates metrics of the differences between capacity and flow of the pipes, in a single pass
+     * @details The differences are the ones of accumulateMetrics. Complexity: O(E), where E is the number of pipes.
      * @param metrics Tuple with values that will hold the metrics
      */
-    void getMetrics(std::tuple<double, double, double> &metrics);
+    void getMetrics(std::tuple<double, double, double> &metrics) const;
 
     /**
-     * @brief Heuristic algorithm to balance the flow between the pipes on the network, whilst keeping the total flow
-     * @details Complexity: O(V*E^3*C), where V is number of service points, E is the number of pipes, and C is the total sum of capacities of the pipes.
-     * @param value Reference value used to update the flow in each pipe. The smaller the value, the more precise the results are but the algorithm is slower.
+     * @brief Sets the number of threads used to calculate the max flow of very large networks
+     * @details The threads are used by push relabel and by the searches of Edmonds Karp (see ParallelBfs for the size
+     * above which the searches are parallel). Complexity: O(1).
+     * @param numThreads Number of threads (0 to use the number of hardware threads, 1 to always run sequentially)
      */
-    void balance(double value);
+    void setMaxFlowThreads(unsigned numThreads);
 
     /**
-     * @brief Store the network from the main graph to the auxiliary graph
-     * @details Complexity: O(E), where E is the number of edges in the graph
+     * @brief Balances the flow between the pipes on the network, whilst keeping the total flow
+     * @details Starting from the cached max flow, the variance of the differences between capacity and flow (as
+     * reported by getMetrics) is minimized by moving flow along cycles of the residual graph (see BalancingEngine).
+     * The balanced flow is left in the network, and the cached max flow is not changed. Complexity: O(C*V*E), where C
+     * is the number of cycles moved, V is the number of service points and E is the number of pipes.
+     * @param timeBudget Maximum time of the balancing in seconds (0 for no limit)
+     * @param progressCallback Function called with the progress of the balancing after each phase
+     * @return Final state of the balancing
+     */
+    BalanceProgress balance(double timeBudget = 0,
+                            const std::function<void(const BalanceProgress &)> &progressCallback = nullptr);
+
+    /**
+     * @brief Store the flows of the network from the main graph to an auxiliary graph
+     * @details The auxiliary graph is not the one of the cached max flow, so the cache is not changed. Complexity: O(E),
+     * where E is the number of edges in the graph
      */
     void storeNetwork();
 
     /**
-     * @brief Load the network from an auxiliary graph to the main graph
+     * @brief Load the flows of the network from the auxiliary graph to the main graph
      * @details Complexity: O(E), where E is the number of edges in the graph
      */
     void loadNetwork();
@@ -272,12 +545,28 @@ private:
 
     /**
      * @brief Parses the file with the information of the stations
-     * @details Complexity: O(n), where n is the number of lines in the file
+     * @details Each line may have two optional columns: the pumping cost and the throughput limit of the station, which
+     * is split in two vertices if it has one (see StationOutlet). Complexity: O(n), where n is the number of lines in
+     * the file
      * @param stationsPath Path to the stations file
      * @return True upon successfully parsing the file, and false otherwise
      */
     bool parseStations(const std::string& stationsPath);
 
+    /**
+     * @brief Returns the code of the service point from which the outgoing pipes of a service point leave
+     * @param code Code of the service point
+     * @return Code of the outlet if the service point is a pumping station with a throughput limit, or the code given
+     * otherwise
+     */
+    std::string getOutletCode(const std::string &code);
+
+    /**
+     * @brief Adds the outlet of a pumping station with a throughput limit to the network (see StationOutlet)
+     * @param station Pumping station, already in the network
+     */
+    void addStationOutlet(PumpingStation *station);
+
     /**
      * @brief Parses the file with the information of the cities
      * @details Complexity: O(n), where n is the number of lines in the file
@@ -328,26 +617,75 @@ private:
     void edmondsKarpBfs(ServicePoint* srcSp, ServicePoint *sinkSp);
 
     /**
-     * @brief Reduces the calculated augmenting path and returns it
+     * @brief Performs the BFS of edmondsKarpBfs from the supersource to the supersink with the parallel BFS
+     * @details The visited service points and their paths are set from the result, as edmondsKarpBfs would.
+     * Complexity: O(V+E), where V is the number of vertices and E the number of edges in the graph
+     * @param parallelBfs Parallel BFS of the flow graph
+     */
+    void parallelEdmondsKarpBfs(ParallelBfs &parallelBfs);
+
+    /**
+     * @brief Gives a parallel BFS of the flow graph the threads kept for the searches of the network, if it is worth it
+     * @param parallelBfs Parallel BFS of the flow graph, with the number of threads of the max flow
+     * @return True if the parallel BFS is worth it for the graph, false otherwise
+     */
+    bool prepareParallelBfs(ParallelBfs &parallelBfs);
+
+    /**
+     * @brief Gathers the flows of the pipes, and whether they are hidden, into flat arrays indexed by pipe
+     * @details A pipe is also considered hidden if one of its service points is. The capacities of the flow graph are
+     * updated too. Complexity: O(E), where E is the number of edges in the graph.
+     */
+    void gatherArcs();
+
+    /**
+     * @brief Reduces the calculated augmenting path, leaving its pipes in the augmenting path buffer
      * @details Complexity: O(V), where V is the number of vertices in the graph
      * @param source Reference to the source vertex
      * @param sink Reference to the sink vertex
-     * @return The augmenting path
+     * @return The capacity (flow) of the augmenting path
+     */
+    double reduceAugmentingPath(ServicePoint *source, ServicePoint* sink);
+
+    /**
+     * @brief Adds flow to a pipe in one of the directions, updating its reverse, as in reduceAugmentingPath
+     * @param pipe Pointer to the pipe
+     * @param incoming True if the flow goes in the direction of the pipe, false otherwise
+     * @param value Value of the flow to add
      */
-    AugmentingPath *reduceAugmentingPath(ServicePoint *source, ServicePoint* sink);
+    void addPipeFlow(Pipe *pipe, bool incoming, double value);
+
+    /**
+     * @brief Makes the flows of the pipes respect the capacities and be conserved in every service point
+     * @details See getMaxFlowFrom. Complexity: O(V*E) in the worst case, where V is the number of vertices in the graph
+     * and E the number of edges, and O(E) when the flows were already feasible.
+     * @param flows Vector with the flows, indexed by pipe
+     */
+    void repairFlows(const std::vector<double> &flows);
+
+    /**
+     * @brief Finds the service points that can reach the supersink in the residual graph of the current flow
+     * @details The parallel BFS is used instead if it is worth it for the graph. Complexity: O(V+E), where V is the
+     * number of vertices in the graph and E the number of edges.
+     * @return Vector indexed by service point, non-zero for the service points that can reach the supersink
+     */
+    std::vector<char> findSinkReachable();
 
     /**
      * @brief Subtracts the flow of the augmenting path from the network
-     * @details It also selects the augmenting paths that pass through a pipe, if it becomes with a negative flow.
+     * @details It also selects the augmenting paths that pass through a pipe, if it becomes with a negative flow (when
+     * it is unidirectional) or with a flow over its capacity (when the path went through it in the opposite direction).
      * Complexity: O(V) amortized (O(V^2*E) worst case), where V is the number of vertices in the graph and E the number
      * of edges.
-     * @param augmentingPath Augmenting path to subtract
+     * @param path Index of the augmenting path to subtract
      */
-    void subtractAugmentingPath(const AugmentingPath *augmentingPath);
+    void subtractAugmentingPath(int path);
 
     /**
      * @brief Subtracts the flow of all selected augmenting paths from the network
-     * @details Complexity: O(V^2*E), where V is the number of vertices in the graph and E the number of edges.
+     * @details Only the selected paths are visited, including the ones selected while subtracting, so the cost depends
+     * on the number of paths affected and not on the size of the decomposition. Complexity: O(n*V), where n is the
+     * number of selected paths and V the number of vertices in the graph.
      */
     void subtractAugmentingPaths();
 
@@ -361,12 +699,31 @@ private:
     double recalculateMaxFlow();
 
     /**
-     * @brief Unselects all the augmenting paths.
-     * @details Complexity: O(n), where n is the number of augmenting paths (worst case O(V*E), where V is the number of
-     * vertices and E the number of edges in the graph).
+     * @brief Updates the cached max flow after changes that only affected the capacities of the pipes
+     * @details Starting from the cached flow, the augmenting paths that pass through the pipes whose flow no longer fits
+     * their capacity are subtracted (along with the ones selected in cascade), and the flow is then augmented again. The decomposition is updated with the new augmenting paths. Complexity: O(V*E^2), where V
+     * is the number of vertices in the graph and E the number of edges, but usually close to O(n*V+E), where n is the
+     * number of augmenting paths affected.
+     * @return The new max flow value
+     */
+    double updateCachedMaxFlow();
+
+    /**
+     * @brief Unselects all the selected augmenting paths.
+     * @details Complexity: O(n), where n is the number of selected augmenting paths.
      */
     void unselectAllAugmentingPaths();
 
+    /**
+     * @brief Freezes the network, fixing a deterministic order of the service points and pipes
+     * @details The service points are ordered by id and code, the pipes of each service point by the service point on
+     * the other end, and every service point and pipe gets a sequential index by that order. Since the searches follow
+     * this order, the max flow and its augmenting paths are the same in every run. It also builds the flat snapshot of
+     * the network used by the parallel engines. Complexity: O(V*log(V)+E*log(E)), where V is the number
+     * of vertices and E the number of edges in the graph.
+     */
+    void freeze();
+
     /**
      * @brief Copies the graph and the flows from one network to another
      * @param network1 Source network
@@ -377,19 +734,56 @@ private:
 
     /**
      * @brief Copies the flows from one network to another
+     * @details Both networks must have the same graph (e.g. one was copied from the other), so that the pipes have the
+     * same indexes. Complexity: O(E), where E is the number of edges in the graph.
      * @param network1 Source network
      * @param network2 Destination network
-     * @details Complexity: O(E), where E is the number of edges in the graph.
      */
     void copyFlows(WaterSupplyNetwork *network1, WaterSupplyNetwork *network2);
 
+    /**
+     * @brief Adds to a failure engine the elements of the network that can fail: each pipe (both directions of a
+     * bidirectional pipe together), each pumping station and each reservoir
+     * @details Complexity: O(V+E), where V is the number of vertices and E the number of edges.
+     * @param engine Engine to which the elements are added
+     */
+    void addFailureElements(FailureScenarioEngine &engine);
+
+    /**
+     * @brief Evaluates each element of a failure engine alone, resetting a store with the delivery sites of the network
+     * and the cached max flow as the baseline
+     * @param engine Engine built over the cached max flow
+     * @param store Store where the results are saved, one scenario per element
+     * @param numThreads Number of threads to use (0 to use the number of hardware threads)
+     */
+    void sweepEngine(const FailureScenarioEngine &engine, ScenarioResultStore &store, unsigned numThreads);
+
     /**
      * @brief Pointer to auxiliary network, used to store the normal max flow
      */
     WaterSupplyNetwork *maxFlowNetwork;
+    /**
+     * @brief Pointer to auxiliary network, used by storeNetwork and loadNetwork
+     */
+    WaterSupplyNetwork *storedNetwork;
+    unsigned long version;
+    unsigned long topologyVersion;
+    unsigned long cachedVersion;
+    unsigned long storedTopologyVersion;
     ServicePoint *superSource;
     ServicePoint *superSink;
-    std::vector<AugmentingPath*> augmentingPaths;
+    std::vector<ServicePoint*> servicePoints;
+    std::vector<Pipe*> pipes;
+    FlowGraph flowGraph;
+    NetworkDecomposition decomposition;
+    AugmentingPathPool augmentingPaths;
+    std::vector<std::pair<Pipe*, bool>> augmentingPathBuffer;
+    unsigned maxFlowThreads;
+    std::shared_ptr<TaskScheduler> bfsScheduler;
+    std::vector<double> arcFlows;
+    std::vector<char> arcBlocked;
+    std::vector<int> bfsParentArcs;
+    std::vector<char> bfsParentDirect;
 };
 
 
@@ -0,0 +1,167 @@
+#include "AugmentingPathPool.h"
+#include <algorithm>
+
+using namespace std;
+
+AugmentingPathPool::AugmentingPathPool() : pathOffsets(1, 0) {}
+
+void AugmentingPathPool::clear() {
+    arcs.clear();
+    pathOffsets.assign(1, 0);
+    capacities.clear();
+    selected.clear();
+    selection.clear();
+    pipePathOffsets.clear();
+    pipePaths.clear();
+}
+
+int AugmentingPathPool::addPath(const vector<pair<Pipe *, bool>> &pipes, double capacity) {
+    for (const pair<Pipe *, bool> &pair: pipes)
+        arcs.push_back(((uint32_t)pair.first->getIndex() << 1) | (pair.second ? 1u : 0u));
+    pathOffsets.push_back((uint32_t)arcs.size());
+    capacities.push_back(capacity);
+    selected.push_back(false);
+    return (int)capacities.size() - 1;
+}
+
+void AugmentingPathPool::normalize() {
+    auto samePath = [&](int a, int b) {
+        return getPathEnd(a) - getPathBegin(a) == getPathEnd(b) - getPathBegin(b)
+               && equal(arcs.begin() + getPathBegin(a), arcs.begin() + getPathEnd(a), arcs.begin() + getPathBegin(b));
+    };
+
+    vector<int> order(getNumPaths());
+    for (int path = 0; path < getNumPaths(); path++)
+        order[path] = path;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return lexicographical_compare(arcs.begin() + getPathBegin(a), arcs.begin() + getPathEnd(a),
+                                       arcs.begin() + getPathBegin(b), arcs.begin() + getPathEnd(b));
+    });
+
+    vector<uint32_t> newArcs, newPathOffsets(1, 0);
+    vector<double> newCapacities;
+    newArcs.reserve(arcs.size());
+    for (size_t i = 0; i < order.size(); ) {
+        int path = order[i];
+        double capacity = 0;
+        for (; i < order.size() && samePath(path, order[i]); i++)
+            capacity += capacities[order[i]];
+        if (capacity <= 0)
+            continue;
+        newArcs.insert(newArcs.end(), arcs.begin() + getPathBegin(path), arcs.begin() + getPathEnd(path));
+        newPathOffsets.push_back((uint32_t)newArcs.size());
+        newCapacities.push_back(capacity);
+    }
+
+    arcs.swap(newArcs);
+    pathOffsets.swap(newPathOffsets);
+    capacities.swap(newCapacities);
+    selected.assign(capacities.size(), false);
+    selection.clear();
+    pipePathOffsets.clear();
+    pipePaths.clear();
+}
+
+void AugmentingPathPool::buildPipeIndex(const vector<Pipe *> &pipes) {
+    pipePathOffsets.assign(pipes.size() + 1, 0);
+
+    // Count the paths of each pipe, shifted by one position to compute the offsets in place
+    for (int path = 0; path < getNumPaths(); path++) {
+        for (uint32_t arc = getPathBegin(path); arc < getPathEnd(path); arc++) {
+            Pipe *pipe = pipes[getArcPipe(arc)];
+            pipePathOffsets[pipe->getIndex() + 1]++;
+            if (pipe->getReverse() != nullptr)
+                pipePathOffsets[pipe->getReverse()->getIndex() + 1]++;
+        }
+    }
+    for (size_t i = 1; i < pipePathOffsets.size(); i++)
+        pipePathOffsets[i] += pipePathOffsets[i - 1];
+
+    pipePaths.resize(pipePathOffsets.back());
+    vector<uint32_t> next(pipePathOffsets.begin(), pipePathOffsets.end() - 1);
+    for (int path = 0; path < getNumPaths(); path++) {
+        for (uint32_t arc = getPathBegin(path); arc < getPathEnd(path); arc++) {
+            Pipe *pipe = pipes[getArcPipe(arc)];
+            pipePaths[next[pipe->getIndex()]++] = path;
+            if (pipe->getReverse() != nullptr)
+                pipePaths[next[pipe->getReverse()->getIndex()]++] = path;
+        }
+    }
+
+    arcs.shrink_to_fit();
+    pathOffsets.shrink_to_fit();
+    capacities.shrink_to_fit();
+}
+
+int AugmentingPathPool::getNumPaths() const {
+    return (int)capacities.size();
+}
+
+uint32_t AugmentingPathPool::getPathBegin(int path) const {
+    return pathOffsets[path];
+}
+
+uint32_t AugmentingPathPool::getPathEnd(int path) const {
+    return pathOffsets[path + 1];
+}
+
+int AugmentingPathPool::getArcPipe(uint32_t arc) const {
+    return (int)(arcs[arc] >> 1);
+}
+
+bool AugmentingPathPool::isArcDirect(uint32_t arc) const {
+    return (arcs[arc] & 1u) != 0;
+}
+
+double AugmentingPathPool::getCapacity(int path) const {
+    return capacities[path];
+}
+
+vector<uint32_t>::const_iterator AugmentingPathPool::getPipePathsBegin(int pipe) const {
+    if (pipe + 1 >= (int)pipePathOffsets.size())
+        return pipePaths.end();
+    return pipePaths.begin() + pipePathOffsets[pipe];
+}
+
+vector<uint32_t>::const_iterator AugmentingPathPool::getPipePathsEnd(int pipe) const {
+    if (pipe + 1 >= (int)pipePathOffsets.size())
+        return pipePaths.end();
+    return pipePaths.begin() + pipePathOffsets[pipe + 1];
+}
+
+bool AugmentingPathPool::isSelected(int path) const {
+    return selected[path];
+}
+
+bool AugmentingPathPool::select(int path) {
+    if (selected[path])
+        return false;
+    selected[path] = true;
+    selection.push_back(path);
+    return true;
+}
+
+void AugmentingPathPool::selectPipePaths(int pipe) {
+    for (auto it = getPipePathsBegin(pipe); it != getPipePathsEnd(pipe); it++)
+        select((int)*it);
+}
+
+void AugmentingPathPool::discardSelected() {
+    for (int path: selection)
+        capacities[path] = 0;
+    unselectAll();
+}
+
+int AugmentingPathPool::getNumSelected() const {
+    return (int)selection.size();
+}
+
+int AugmentingPathPool::getSelected(int i) const {
+    return selection[i];
+}
+
+void AugmentingPathPool::unselectAll() {
+    for (int path: selection)
+        selected[path] = false;
+    selection.clear();
+}
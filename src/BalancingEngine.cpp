@@ -0,0 +1,213 @@
+#include "BalancingEngine.h"
+#include "FlowKernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Costs and flows closer than this are considered equal
+ */
+static const double BALANCE_EPSILON = 1e-9;
+
+BalancingEngine::BalancingEngine(const FlowGraph &graph, vector<double> &flows, const vector<char> &excludedArcs)
+        : graph(graph), flows(flows), arcPipes(graph.getNumArcs(), -1), timeBudget(0), minStep(1) {
+    for (int arc = 0; arc < graph.getNumArcs(); arc++) {
+        if (graph.getTail(arc) == graph.getSource() || graph.getHead(arc) == graph.getSink() || excludedArcs[arc])
+            continue;
+        int reverse = graph.getReverse(arc);
+        if (reverse != -1 && reverse < arc) {
+            arcPipes[arc] = arcPipes[reverse];
+            continue;
+        }
+        arcPipes[arc] = (int)pipeArcs.size();
+        pipeArcs.push_back(arc);
+    }
+    resetSlacks();
+}
+
+void BalancingEngine::setTimeBudget(double seconds) {
+    timeBudget = seconds;
+}
+
+void BalancingEngine::setMinStep(double step) {
+    minStep = step;
+}
+
+void BalancingEngine::setProgressCallback(const function<void(const BalanceProgress &)> &callback) {
+    progressCallback = callback;
+}
+
+double BalancingEngine::getSlack(int pipe) const {
+    int arc = pipeArcs[pipe], reverse = graph.getReverse(arc);
+    if (reverse == -1 || flows[arc] >= 0)
+        return graph.getCapacity(arc) - flows[arc];
+    return graph.getCapacity(reverse) - flows[reverse];
+}
+
+double BalancingEngine::getSlackAfter(int arc, double value) const {
+    int pipeArc = pipeArcs[arcPipes[arc]], reverse = graph.getReverse(pipeArc);
+    double flow = flows[pipeArc] + (arc == pipeArc ? value : -value);
+    if (reverse == -1 || flow >= 0)
+        return graph.getCapacity(pipeArc) - flow;
+    return graph.getCapacity(reverse) + flow;
+}
+
+void BalancingEngine::resetSlacks() {
+    slacks.reset(pipeArcs.size());
+    for (int pipe = 0; pipe < (int)pipeArcs.size(); pipe++)
+        slacks.set(pipe, getSlack(pipe));
+}
+
+tuple<double, double, double> BalancingEngine::getMetrics() const {
+    return slacks.getMetrics();
+}
+
+void BalancingEngine::buildMoves(double step, double mean) {
+    auto moveCost = [&](int arc, double value) {
+        int pipe = arcPipes[arc];
+        if (pipe == -1)
+            return 0.0;
+        double before = getSlack(pipe) - mean, after = getSlackAfter(arc, value) - mean;
+        return after * after - before * before;
+    };
+
+    moves.clear();
+    remaining.resize(flows.size());
+    FlowKernels::residuals(graph.getCapacities().data(), flows.data(), remaining.data(), flows.size());
+    for (int arc = 0; arc < graph.getNumArcs(); arc++) {
+        int tail = graph.getTail(arc), head = graph.getHead(arc);
+        if (step <= remaining[arc] + BALANCE_EPSILON)
+            moves.push_back(Move{tail, head, arc, true, moveCost(arc, step)});
+        // The flow of a bidirectional pipe is taken back by moving it forward through the reverse arc
+        if (graph.getReverse(arc) == -1 && flows[arc] - step >= -BALANCE_EPSILON)
+            moves.push_back(Move{head, tail, arc, false, moveCost(arc, -step)});
+    }
+}
+
+bool BalancingEngine::findNegativeCycle(vector<int> &cycle) {
+    int numVertices = graph.getNumVertices();
+    distances.assign(numVertices, 0);
+    parentMoves.assign(numVertices, -1);
+    vector<int> seen(numVertices, -1);
+
+    // Every vertex starts at distance 0, as if connected to a virtual root, so that cycles are found anywhere
+    for (int pass = 0; pass < numVertices; pass++) {
+        int last = -1;
+        for (int m = 0; m < (int)moves.size(); m++) {
+            const Move &move = moves[m];
+            // Going back through the same pipe only undoes the move, but the difference is not convex in the flow of a
+            // bidirectional pipe (it is capacity minus the absolute value), so it could look like a negative cycle
+            int parent = parentMoves[move.from];
+            if (parent != -1 && arcPipes[move.arc] != -1 && arcPipes[moves[parent].arc] == arcPipes[move.arc])
+                continue;
+            if (distances[move.from] + move.cost < distances[move.to] - BALANCE_EPSILON) {
+                distances[move.to] = distances[move.from] + move.cost;
+                parentMoves[move.to] = m;
+                last = move.to;
+            }
+        }
+        if (last == -1)
+            return false;
+
+        // A cycle in the parent pointers is a negative cycle, so look for one from the last vertex relaxed
+        int v = last;
+        while (v != -1 && seen[v] != pass) {
+            seen[v] = pass;
+            v = parentMoves[v] == -1 ? -1 : moves[parentMoves[v]].from;
+        }
+        if (v == -1)
+            continue;
+
+        cycle.clear();
+        double cost = 0;
+        int u = v;
+        do {
+            cycle.push_back(parentMoves[u]);
+            cost += moves[parentMoves[u]].cost;
+            u = moves[parentMoves[u]].from;
+        } while (u != v);
+        if (cost < -BALANCE_EPSILON)
+            return true;
+    }
+    return false;
+}
+
+bool BalancingEngine::pushCycle(const vector<int> &cycle, double value) {
+    for (int m: cycle) {
+        int arc = moves[m].arc, reverse = graph.getReverse(arc);
+        flows[arc] += moves[m].direct ? value : -value;
+        if (reverse != -1)
+            flows[reverse] -= moves[m].direct ? value : -value;
+        if (arcPipes[arc] != -1)
+            slacks.set(arcPipes[arc], getSlack(arcPipes[arc]));
+    }
+    // A cycle can go through the same arc more than once, so the capacities are checked after all the moves
+    for (int m: cycle) {
+        int arc = moves[m].arc, reverse = graph.getReverse(arc);
+        if (flows[arc] > graph.getCapacity(arc) + BALANCE_EPSILON
+            || (reverse == -1 && flows[arc] < -BALANCE_EPSILON)
+            || (reverse != -1 && flows[reverse] > graph.getCapacity(reverse) + BALANCE_EPSILON))
+            return false;
+    }
+    return true;
+}
+
+BalanceProgress BalancingEngine::run() {
+    auto start = chrono::steady_clock::now();
+    auto elapsed = [&]() {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+
+    double maxCapacity = 0;
+    for (int arc: pipeArcs)
+        maxCapacity = max(maxCapacity, graph.getCapacity(arc));
+    double step = minStep;
+    while (step * 2 <= maxCapacity)
+        step *= 2;
+
+    BalanceProgress progress;
+    progress.cyclesCancelled = 0;
+    progress.step = step;
+    progress.elapsedSeconds = 0;
+    progress.metrics = getMetrics();
+    if (progressCallback)
+        progressCallback(progress);
+
+    vector<int> cycle;
+    bool timeUp = false;
+    while (step >= minStep && !timeUp) {
+        buildMoves(step, get<1>(progress.metrics));
+        bool improved = false;
+        if (findNegativeCycle(cycle)) {
+            // The cost of the cycle is only an estimate, so it is kept only if the real variance dropped
+            bool feasible = pushCycle(cycle, step);
+            tuple<double, double, double> metrics = getMetrics();
+            improved = feasible && get<2>(metrics) < get<2>(progress.metrics) - BALANCE_EPSILON;
+            if (improved) {
+                progress.cyclesCancelled++;
+                progress.metrics = metrics;
+            } else {
+                pushCycle(cycle, -step);
+            }
+        }
+        if (!improved) {
+            step /= 2;
+            resetSlacks();
+            progress.metrics = getMetrics();
+        }
+
+        timeUp = timeBudget > 0 && elapsed() > timeBudget;
+        if (step != progress.step || timeUp) {
+            progress.step = step;
+            progress.elapsedSeconds = elapsed();
+            if (progressCallback && (step >= minStep || timeUp))
+                progressCallback(progress);
+        }
+    }
+
+    progress.elapsedSeconds = elapsed();
+    return progress;
+}
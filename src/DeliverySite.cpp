@@ -18,10 +18,7 @@ int DeliverySite::getPopulation() const {
 }
 
 double DeliverySite::getSupplyRate() const {
-    double rate = 0;
-    for (Pipe *pipe: ServicePoint::getIncoming())
-        rate += pipe->getFlow();
-    return rate;
+    return getInflow();
 }
 
 std::string DeliverySite::getDescription() const {
@@ -0,0 +1,106 @@
+#include "FailureBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+/**
+ * @brief Times below this are rounded up to it when calculating speedups, so that they stay finite
+ */
+static const double MIN_TIME = 1e-9;
+
+/**
+ * @brief Returns a percentile of some values, by the nearest-rank method
+ * @details Complexity: O(n*log(n)), where n is the number of values.
+ * @param values Vector with the values, which must not be empty
+ * @param percentile Percentile, between 0 and 1
+ * @return Smallest value that is greater than or equal to the given fraction of the values
+ */
+static double getPercentile(vector<double> values, double percentile) {
+    sort(values.begin(), values.end());
+    size_t rank = (size_t)ceil(percentile * (double)values.size());
+    return values[rank == 0 ? 0 : rank - 1];
+}
+
+FailureBenchmark::FailureBenchmark(WaterSupplyNetwork &wsn) : wsn(wsn) {}
+
+void FailureBenchmark::addCase(const string &kind, const string &description, const function<double()> &incremental,
+                               const function<double()> &bruteForce, unsigned repetitions) {
+    // Each run starts from the cached max flow and leaves every service point and pipe visible for the next one
+    auto measure = [&](const function<double()> &algorithm, double &flow) {
+        double best = 0;
+        for (unsigned r = 0; r < repetitions; r++) {
+            wsn.loadCachedMaxFlow();
+            auto start = chrono::steady_clock::now();
+            flow = algorithm();
+            double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            best = r == 0 ? time : min(best, time);
+            wsn.unhideAllPipes();
+            wsn.unhideAllServicePoints();
+        }
+        return best;
+    };
+
+    BenchmarkCase benchmarkCase;
+    benchmarkCase.kind = kind;
+    benchmarkCase.description = description;
+    benchmarkCase.incrementalTime = measure(incremental, benchmarkCase.incrementalFlow);
+    benchmarkCase.bruteForceTime = measure(bruteForce, benchmarkCase.bruteForceFlow);
+    benchmarkCase.diverges = fabs(benchmarkCase.incrementalFlow - benchmarkCase.bruteForceFlow)
+                             > WaterSupplyNetwork::getFlowTolerance(benchmarkCase.bruteForceFlow);
+    cases.push_back(benchmarkCase);
+}
+
+void FailureBenchmark::run(unsigned repetitions) {
+    cases.clear();
+    repetitions = max(repetitions, 1u);
+
+    wsn.forEachFailureElement(
+            [&](Pipe *pipe) {
+                addCase("Pipe", WaterSupplyNetwork::getPipeDescription(pipe),
+                        [&]() { return wsn.getMaxFlowWithoutPipes({pipe}); },
+                        [&]() { return wsn.getMaxFlowWithoutPipesBF({pipe}); }, repetitions);
+            },
+            [&](Reservoir *reservoir) {
+                addCase("Reservoir", reservoir->getCode(),
+                        [&]() { return wsn.getMaxFlowWithoutReservoir(reservoir); },
+                        [&]() { return wsn.getMaxFlowWithoutReservoirBF(reservoir); }, repetitions);
+            },
+            [&](PumpingStation *station) {
+                addCase("Station", station->getCode(),
+                        [&]() { return wsn.getMaxFlowWithoutStation(station); },
+                        [&]() { return wsn.getMaxFlowWithoutStationBF(station); }, repetitions);
+            });
+
+    wsn.loadCachedMaxFlow();
+}
+
+const vector<BenchmarkCase> &FailureBenchmark::getCases() const {
+    return cases;
+}
+
+vector<BenchmarkSummary> FailureBenchmark::getSummaries() const {
+    vector<BenchmarkSummary> summaries;
+    for (const string &kind: {string("Pipe"), string("Reservoir"), string("Station")}) {
+        BenchmarkSummary summary = {kind, 0, 0, 0, 0, 0, 0};
+        vector<double> speedups;
+        for (const BenchmarkCase &benchmarkCase: cases) {
+            if (benchmarkCase.kind != kind)
+                continue;
+            summary.numCases++;
+            summary.numDivergent += benchmarkCase.diverges;
+            summary.incrementalTime += benchmarkCase.incrementalTime;
+            summary.bruteForceTime += benchmarkCase.bruteForceTime;
+            speedups.push_back(max(benchmarkCase.bruteForceTime, MIN_TIME)
+                               / max(benchmarkCase.incrementalTime, MIN_TIME));
+        }
+        if (speedups.empty())
+            continue;
+        summary.medianSpeedup = getPercentile(speedups, 0.5);
+        summary.p99Speedup = getPercentile(speedups, 0.99);
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
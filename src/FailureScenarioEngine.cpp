@@ -0,0 +1,256 @@
+#include "FailureScenarioEngine.h"
+
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+/**
+ * @brief Flows with an absolute value below this are considered zero
+ */
+static const double FLOW_EPSILON = 1e-9;
+
+/**
+ * @brief Worst value found for a quantity, along with the combination that caused it
+ */
+struct WorstCase {
+    double value;
+    uint64_t order;
+    vector<int> combination;
+};
+
+/**
+ * @brief Updates a worst case if the value is smaller, or equal but found in an earlier combination
+ * @details The worst cases start with order 0 and the combinations are numbered from 1, so a combination must be
+ * strictly worse than the normal value to be reported.
+ * @param worst Worst case to update
+ * @param value Value of the quantity
+ * @param order Order of the combination (smaller combinations first)
+ * @param combination Vector with the indexes of the failed elements
+ */
+static void updateWorstCase(WorstCase &worst, double value, uint64_t order, const vector<int> &combination) {
+    if (value < worst.value - FLOW_EPSILON || (fabs(value - worst.value) <= FLOW_EPSILON && order < worst.order)) {
+        worst.value = value;
+        worst.order = order;
+        worst.combination = combination;
+    }
+}
+
+FailureScenarioEngine::FailureScenarioEngine(const FlowGraph &graph, const vector<double> &baselineFlows,
+                                             const AugmentingPathPool &baselinePaths)
+        : graph(graph), baselineFlows(baselineFlows), baselinePaths(baselinePaths) {}
+
+void FailureScenarioEngine::addElement(const string &description, const vector<int> &arcs, double capacityFactor) {
+    FailureElement element;
+    element.description = description;
+    element.arcs = arcs;
+    element.capacityFactor = capacityFactor;
+    // A failed arc takes its twin with it, which carries its own flow and paths (unlike its reverse)
+    if (capacityFactor == 0) {
+        for (int arc: arcs) {
+            int twin = graph.getTwin(arc);
+            if (twin != -1 && find(element.arcs.begin(), element.arcs.end(), twin) == element.arcs.end())
+                element.arcs.push_back(twin);
+        }
+    }
+    elements.push_back(element);
+}
+
+const vector<FailureElement> &FailureScenarioEngine::getElements() const {
+    return elements;
+}
+
+void FailureScenarioEngine::computeActivity(const vector<double> &flows, uint64_t *activity) const {
+    for (size_t e = 0; e < elements.size(); e++) {
+        bool active = false;
+        for (int arc: elements[e].arcs)
+            active = active || fabs(flows[arc]) > FLOW_EPSILON;
+        if (active)
+            activity[e / 64] |= (uint64_t)1 << (e % 64);
+        else
+            activity[e / 64] &= ~((uint64_t)1 << (e % 64));
+    }
+}
+
+void FailureScenarioEngine::evaluate(FlowSolver &solver, const vector<int> &combination) const {
+    vector<int> arcs;
+    solver.clearFailures();
+    solver.setFlows(baselineFlows);
+    for (int e: combination) {
+        const FailureElement &element = elements[e];
+        arcs.insert(arcs.end(), element.arcs.begin(), element.arcs.end());
+        for (int arc: element.arcs) {
+            if (element.capacityFactor > 0)
+                solver.limitArc(arc, element.capacityFactor * graph.getCapacity(arc));
+            else
+                solver.failArc(arc);
+        }
+    }
+    // All the paths through the elements are subtracted, even the ones that would fit in the reduced capacities
+    solver.subtractPaths(baselinePaths, arcs);
+    solver.augment();
+}
+
+FailureReport FailureScenarioEngine::analyse(int k, const vector<int> &cities, unsigned numThreads) const {
+    int n = (int)elements.size();
+    size_t words = (elements.size() + 63) / 64;
+    k = max(0, min(k, n));
+    TaskScheduler scheduler(numThreads);
+    numThreads = scheduler.getNumWorkers();
+    vector<FlowSolver> solvers(numThreads, FlowSolver(graph));
+
+    // binomial[i][j] = i choose j, used to rank combinations in colexicographic order
+    vector<vector<uint64_t>> binomial(n + 1, vector<uint64_t>(k + 1, 0));
+    for (int i = 0; i <= n; i++) {
+        binomial[i][0] = 1;
+        for (int j = 1; j <= min(i, k); j++)
+            binomial[i][j] = binomial[i - 1][j - 1] + (j <= i - 1 ? binomial[i - 1][j] : 0);
+    }
+    auto rank = [&](const vector<int> &combination, int skip) {
+        uint64_t r = 0;
+        int pos = 0;
+        for (int i = 0; i < (int)combination.size(); i++) {
+            if (i == skip)
+                continue;
+            r += binomial[combination[i]][++pos];
+        }
+        return r;
+    };
+
+    FailureReport report;
+    report.k = k;
+    report.numCombinations = report.numPruned = report.numEvaluated = 0;
+    report.normalFlow = graph.getInflow(baselineFlows, graph.getSink());
+
+    vector<double> normalSupply(cities.size(), 0);
+    for (size_t c = 0; c < cities.size(); c++)
+        normalSupply[c] = graph.getInflow(baselineFlows, cities[c]);
+
+    // Scenario 0 is the baseline; activities[s*words...] tells which elements carry flow in scenario s
+    vector<uint64_t> activities(words, 0);
+    computeActivity(baselineFlows, activities.data());
+    auto isActive = [&](int scenario, int e) {
+        return (activities[scenario * words + e / 64] >> (e % 64)) & 1;
+    };
+
+    vector<int> prevReps(1, 0);
+    vector<WorstCase> worstFlow(numThreads, WorstCase{report.normalFlow, 0, vector<int>()});
+    vector<vector<WorstCase>> worstSupply(numThreads, vector<WorstCase>(cities.size()));
+    for (unsigned t = 0; t < numThreads; t++) {
+        for (size_t c = 0; c < cities.size(); c++)
+            worstSupply[t][c] = WorstCase{normalSupply[c], 0, vector<int>()};
+    }
+
+    uint64_t order = 1;
+    for (int m = 1; m <= k; m++) {
+        bool lastLevel = m == k;
+        vector<int> reps(lastLevel ? 0 : binomial[n][m]);
+        vector<int> survivors;
+
+        // Enumerate the combinations of size m in lexicographic order, keeping only the ones that are not dominated
+        vector<int> combination(m);
+        for (int i = 0; i < m; i++)
+            combination[i] = i;
+        while (true) {
+            report.numCombinations++;
+            int rep = -1;
+            for (int j = 0; j < m && rep == -1; j++) {
+                int subsetRep = prevReps[rank(combination, j)];
+                if (!isActive(subsetRep, combination[j]))
+                    rep = subsetRep;
+            }
+            if (rep != -1) {
+                report.numPruned++;
+            } else {
+                rep = -2 - (int)(survivors.size() / m);
+                survivors.insert(survivors.end(), combination.begin(), combination.end());
+            }
+            if (!lastLevel)
+                reps[rank(combination, -1)] = rep;
+
+            int i = m - 1;
+            while (i >= 0 && combination[i] == n - m + i)
+                i--;
+            if (i < 0)
+                break;
+            combination[i]++;
+            for (int j = i + 1; j < m; j++)
+                combination[j] = combination[j - 1] + 1;
+        }
+
+        size_t numSurvivors = survivors.size() / m;
+        int firstScenario = (int)(activities.size() / words);
+        if (!lastLevel)
+            activities.resize(activities.size() + numSurvivors * words, 0);
+        report.numEvaluated += numSurvivors;
+
+        vector<vector<int>> current(numThreads, vector<int>(m));
+        scheduler.run(numSurvivors, [&](size_t s, unsigned t) {
+            FlowSolver &solver = solvers[t];
+            current[t].assign(survivors.begin() + s * m, survivors.begin() + (s + 1) * m);
+            evaluate(solver, current[t]);
+            updateWorstCase(worstFlow[t], solver.getFlowValue(), order + s, current[t]);
+            for (size_t c = 0; c < cities.size(); c++)
+                updateWorstCase(worstSupply[t][c], solver.getInflow(cities[c]), order + s, current[t]);
+            if (!lastLevel)
+                computeActivity(solver.getFlows(), &activities[(firstScenario + s) * words]);
+        });
+        order += numSurvivors;
+
+        for (int &rep: reps) {
+            if (rep < -1)
+                rep = firstScenario + (-2 - rep);
+        }
+        prevReps.swap(reps);
+    }
+
+    // Merge the worst cases found by each thread
+    auto describe = [&](const vector<int> &combination) {
+        vector<string> descriptions;
+        for (int e: combination)
+            descriptions.push_back(elements[e].description);
+        return descriptions;
+    };
+    for (unsigned t = 1; t < numThreads; t++) {
+        updateWorstCase(worstFlow[0], worstFlow[t].value, worstFlow[t].order, worstFlow[t].combination);
+        for (size_t c = 0; c < cities.size(); c++)
+            updateWorstCase(worstSupply[0][c], worstSupply[t][c].value, worstSupply[t][c].order, worstSupply[t][c].combination);
+    }
+    report.worstFlow = worstFlow[0].value;
+    report.worstFlowFailures = describe(worstFlow[0].combination);
+    for (size_t c = 0; c < cities.size(); c++) {
+        CityFailureReport cityReport;
+        cityReport.city = nullptr;
+        cityReport.vertex = cities[c];
+        cityReport.normalSupply = normalSupply[c];
+        cityReport.worstSupply = worstSupply[0][c].value;
+        cityReport.failures = describe(worstSupply[0][c].combination);
+        report.cities.push_back(cityReport);
+    }
+    return report;
+}
+
+void FailureScenarioEngine::sweep(const vector<int> &cities, ScenarioResultStore &store, unsigned numThreads) const {
+    TaskScheduler scheduler(numThreads);
+    vector<FlowSolver> solvers(scheduler.getNumWorkers(), FlowSolver(graph));
+
+    vector<double> normalSupply(cities.size(), 0);
+    for (size_t c = 0; c < cities.size(); c++)
+        normalSupply[c] = graph.getInflow(baselineFlows, cities[c]);
+    vector<uint64_t> activity((elements.size() + 63) / 64, 0);
+    computeActivity(baselineFlows, activity.data());
+
+    size_t firstRow = store.reserveScenarios(elements.size());
+    vector<vector<double>> supplies(scheduler.getNumWorkers(), vector<double>(cities.size()));
+    scheduler.run(elements.size(), [&](size_t e, unsigned t) {
+        if (((activity[e / 64] >> (e % 64)) & 1) == 0) {
+            store.setScenario(firstRow + e, elements[e].description, normalSupply);
+            return;
+        }
+        evaluate(solvers[t], vector<int>(1, (int)e));
+        for (size_t c = 0; c < cities.size(); c++)
+            supplies[t][c] = solvers[t].getInflow(cities[c]);
+        store.setScenario(firstRow + e, elements[e].description, supplies[t]);
+    });
+}
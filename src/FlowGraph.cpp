@@ -0,0 +1,145 @@
+#include "FlowGraph.h"
+#include "FlowKernels.h"
+
+using namespace std;
+
+FlowGraph::FlowGraph() : source(-1), sink(-1), outOffsets(1, 0), inOffsets(1, 0) {}
+
+void FlowGraph::build(const vector<ServicePoint *> &servicePoints, const vector<Pipe *> &pipes,
+                      const ServicePoint *source, const ServicePoint *sink) {
+    int numVertices = (int)servicePoints.size(), numArcs = (int)pipes.size();
+    this->source = source->getIndex();
+    this->sink = sink->getIndex();
+
+    tails.resize(numArcs);
+    heads.resize(numArcs);
+    reverses.resize(numArcs);
+    twins.resize(numArcs);
+    capacities.resize(numArcs);
+    for (Pipe *pipe: pipes) {
+        int arc = pipe->getIndex();
+        tails[arc] = pipe->getOrig()->getIndex();
+        heads[arc] = pipe->getDest()->getIndex();
+        reverses[arc] = pipe->getReverse() != nullptr ? pipe->getReverse()->getIndex() : -1;
+        twins[arc] = pipe->getTwin() != nullptr ? pipe->getTwin()->getIndex() : -1;
+        capacities[arc] = pipe->getCapacity();
+    }
+
+    // The arcs of each vertex keep the order of the pipes in the service point
+    outOffsets.assign(numVertices + 1, 0);
+    inOffsets.assign(numVertices + 1, 0);
+    outArcs.clear();
+    inArcs.clear();
+    for (ServicePoint *sp: servicePoints) {
+        for (Pipe *pipe: sp->getAdj())
+            outArcs.push_back(pipe->getIndex());
+        for (Pipe *pipe: sp->getIncoming())
+            inArcs.push_back(pipe->getIndex());
+        outOffsets[sp->getIndex() + 1] = (int)outArcs.size();
+        inOffsets[sp->getIndex() + 1] = (int)inArcs.size();
+    }
+}
+
+void FlowGraph::build(int numVertices, int source, int sink, const vector<int> &tails, const vector<int> &heads,
+                      const vector<int> &reverses, const vector<double> &capacities) {
+    this->source = source;
+    this->sink = sink;
+    this->tails = tails;
+    this->heads = heads;
+    this->reverses = reverses;
+    this->twins.assign(reverses.size(), -1);
+    this->capacities = capacities;
+
+    // Counting sort of the arcs by vertex, which keeps them in the order of their indexes
+    int numArcs = (int)heads.size();
+    outOffsets.assign(numVertices + 1, 0);
+    inOffsets.assign(numVertices + 1, 0);
+    for (int arc = 0; arc < numArcs; arc++) {
+        outOffsets[tails[arc] + 1]++;
+        inOffsets[heads[arc] + 1]++;
+    }
+    for (int v = 0; v < numVertices; v++) {
+        outOffsets[v + 1] += outOffsets[v];
+        inOffsets[v + 1] += inOffsets[v];
+    }
+    outArcs.resize(numArcs);
+    inArcs.resize(numArcs);
+    vector<int> outPos(outOffsets.begin(), outOffsets.end() - 1), inPos(inOffsets.begin(), inOffsets.end() - 1);
+    for (int arc = 0; arc < numArcs; arc++) {
+        outArcs[outPos[tails[arc]]++] = arc;
+        inArcs[inPos[heads[arc]]++] = arc;
+    }
+}
+
+void FlowGraph::updateCapacities(const vector<Pipe *> &pipes) {
+    for (Pipe *pipe: pipes)
+        capacities[pipe->getIndex()] = pipe->getCapacity();
+}
+
+int FlowGraph::getNumVertices() const {
+    return (int)outOffsets.size() - 1;
+}
+
+int FlowGraph::getNumArcs() const {
+    return (int)heads.size();
+}
+
+int FlowGraph::getSource() const {
+    return source;
+}
+
+int FlowGraph::getSink() const {
+    return sink;
+}
+
+int FlowGraph::getTail(int arc) const {
+    return tails[arc];
+}
+
+int FlowGraph::getHead(int arc) const {
+    return heads[arc];
+}
+
+int FlowGraph::getReverse(int arc) const {
+    return reverses[arc];
+}
+
+int FlowGraph::getTwin(int arc) const {
+    return twins[arc];
+}
+
+double FlowGraph::getCapacity(int arc) const {
+    return capacities[arc];
+}
+
+const vector<double> &FlowGraph::getCapacities() const {
+    return capacities;
+}
+
+int FlowGraph::getOutBegin(int v) const {
+    return outOffsets[v];
+}
+
+int FlowGraph::getOutEnd(int v) const {
+    return outOffsets[v + 1];
+}
+
+int FlowGraph::getOutArc(int pos) const {
+    return outArcs[pos];
+}
+
+int FlowGraph::getInBegin(int v) const {
+    return inOffsets[v];
+}
+
+int FlowGraph::getInEnd(int v) const {
+    return inOffsets[v + 1];
+}
+
+int FlowGraph::getInArc(int pos) const {
+    return inArcs[pos];
+}
+
+double FlowGraph::getInflow(const vector<double> &flows, int v) const {
+    return FlowKernels::sumIndexed(flows.data(), inArcs.data() + inOffsets[v], inOffsets[v + 1] - inOffsets[v]);
+}
@@ -0,0 +1,215 @@
+#include "FlowGraphReducer.h"
+
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+FlowGraphReducer::FlowGraphReducer(const FlowGraph &graph) : graph(graph), numPruned(0), numContracted(0) {}
+
+void FlowGraphReducer::addLink(int x, int y, double forward, double backward) {
+    // Loops and links that cannot carry water in any direction are dropped, along with their segments
+    if (x == y || (forward <= 0 && backward <= 0)) {
+        segmentArcs.resize(linkBegin.back());
+        segmentSigns.resize(linkBegin.back());
+        return;
+    }
+    int forwardArc = -1, backwardArc = -1;
+    if (forward > 0) {
+        forwardArc = (int)reducedHeads.size();
+        reducedTails.push_back(reducedIndex[x]);
+        reducedHeads.push_back(reducedIndex[y]);
+        reducedReverses.push_back(-1);
+        reducedCapacities.push_back(forward);
+    }
+    if (backward > 0) {
+        backwardArc = (int)reducedHeads.size();
+        reducedTails.push_back(reducedIndex[y]);
+        reducedHeads.push_back(reducedIndex[x]);
+        reducedReverses.push_back(forwardArc);
+        reducedCapacities.push_back(backward);
+        if (forwardArc != -1)
+            reducedReverses[forwardArc] = backwardArc;
+    }
+    linkForward.push_back(forwardArc);
+    linkBackward.push_back(backwardArc);
+    linkBegin.push_back((int)segmentArcs.size());
+}
+
+void FlowGraphReducer::reduce(const vector<char> &blocked) {
+    int numVertices = graph.getNumVertices(), numArcs = graph.getNumArcs();
+    int source = graph.getSource(), sink = graph.getSink();
+
+    // Each unidirectional arc, and each pair of reverse arcs, is an edge with a capacity in each direction
+    vector<int> edgeArcs;
+    vector<double> edgeForward, edgeBackward;
+    for (int arc = 0; arc < numArcs; arc++) {
+        int reverse = graph.getReverse(arc);
+        if ((reverse != -1 && reverse < arc) || graph.getTail(arc) == graph.getHead(arc))
+            continue;
+        double forward = blocked[arc] ? 0 : graph.getCapacity(arc);
+        double backward = reverse == -1 || blocked[reverse] ? 0 : graph.getCapacity(reverse);
+        if (forward <= 0 && backward <= 0)
+            continue;
+        edgeArcs.push_back(arc);
+        edgeForward.push_back(forward);
+        edgeBackward.push_back(backward);
+    }
+    int numEdges = (int)edgeArcs.size();
+    vector<int> offsets(numVertices + 1, 0), incident(2 * numEdges);
+    for (int arc: edgeArcs) {
+        offsets[graph.getTail(arc) + 1]++;
+        offsets[graph.getHead(arc) + 1]++;
+    }
+    for (int v = 0; v < numVertices; v++)
+        offsets[v + 1] += offsets[v];
+    vector<int> pos(offsets.begin(), offsets.end() - 1);
+    for (int e = 0; e < numEdges; e++) {
+        incident[pos[graph.getTail(edgeArcs[e])]++] = e;
+        incident[pos[graph.getHead(edgeArcs[e])]++] = e;
+    }
+    auto other = [&](int e, int v) {
+        int tail = graph.getTail(edgeArcs[e]);
+        return tail == v ? graph.getHead(edgeArcs[e]) : tail;
+    };
+    auto capacityFrom = [&](int e, int v) {
+        return graph.getTail(edgeArcs[e]) == v ? edgeForward[e] : edgeBackward[e];
+    };
+
+    // Vertices reached from the source, and vertices that reach the sink
+    auto search = [&](int root, bool fromRoot) {
+        vector<char> reached(numVertices, false);
+        vector<int> queue(1, root);
+        reached[root] = true;
+        for (size_t head = 0; head < queue.size(); head++) {
+            int u = queue[head];
+            for (int i = offsets[u]; i < offsets[u + 1]; i++) {
+                int e = incident[i], v = other(e, u);
+                if (reached[v] || (fromRoot ? capacityFrom(e, u) : capacityFrom(e, v)) <= 0)
+                    continue;
+                reached[v] = true;
+                queue.push_back(v);
+            }
+        }
+        return reached;
+    };
+    vector<char> kept = search(source, true), toSink = search(sink, false);
+    numPruned = 0;
+    for (int v = 0; v < numVertices; v++) {
+        kept[v] = (kept[v] && toSink[v]) || v == source || v == sink;
+        numPruned += !kept[v];
+    }
+    vector<char> edgeKept(numEdges);
+    vector<int> degree(numVertices, 0);
+    for (int e = 0; e < numEdges; e++) {
+        int tail = graph.getTail(edgeArcs[e]), head = graph.getHead(edgeArcs[e]);
+        edgeKept[e] = kept[tail] && kept[head];
+        if (edgeKept[e]) {
+            degree[tail]++;
+            degree[head]++;
+        }
+    }
+
+    // The vertices inside chains disappear, the others are numbered in the reduced graph
+    vector<char> internal(numVertices, false);
+    reducedIndex.assign(numVertices, -1);
+    int numReduced = 0;
+    numContracted = 0;
+    for (int v = 0; v < numVertices; v++) {
+        internal[v] = kept[v] && v != source && v != sink && degree[v] == 2;
+        numContracted += internal[v];
+        if (kept[v] && !internal[v])
+            reducedIndex[v] = numReduced++;
+    }
+
+    reducedTails.clear();
+    reducedHeads.clear();
+    reducedReverses.clear();
+    reducedCapacities.clear();
+    linkForward.clear();
+    linkBackward.clear();
+    linkBegin.assign(1, 0);
+    segmentArcs.clear();
+    segmentSigns.clear();
+    vector<char> consumed(numEdges, false);
+    for (int x = 0; x < numVertices; x++) {
+        if (reducedIndex[x] == -1)
+            continue;
+        for (int i = offsets[x]; i < offsets[x + 1]; i++) {
+            int e = incident[i];
+            if (!edgeKept[e] || consumed[e])
+                continue;
+            // Walk along the chain that starts with the edge, until a vertex that is not inside a chain
+            double forward = numeric_limits<double>::infinity(), backward = forward;
+            int current = x;
+            while (true) {
+                consumed[e] = true;
+                int next = other(e, current);
+                forward = min(forward, capacityFrom(e, current));
+                backward = min(backward, capacityFrom(e, next));
+                segmentArcs.push_back(edgeArcs[e]);
+                segmentSigns.push_back(graph.getTail(edgeArcs[e]) == current ? 1 : -1);
+                current = next;
+                if (!internal[current])
+                    break;
+                int previous = e;
+                for (int j = offsets[current]; j < offsets[current + 1]; j++) {
+                    if (edgeKept[incident[j]] && incident[j] != previous)
+                        e = incident[j];
+                }
+            }
+            addLink(x, current, forward, backward);
+        }
+    }
+
+    reduced.build(numReduced, reducedIndex[source], reducedIndex[sink], reducedTails, reducedHeads, reducedReverses,
+                  reducedCapacities);
+    reducedBlocked.assign(reducedHeads.size(), false);
+}
+
+const FlowGraph &FlowGraphReducer::getReducedGraph() const {
+    return reduced;
+}
+
+const vector<char> &FlowGraphReducer::getReducedBlocked() const {
+    return reducedBlocked;
+}
+
+vector<double> FlowGraphReducer::reduceCosts(const vector<double> &costs) const {
+    vector<double> reducedCosts(reducedHeads.size(), 0);
+    for (size_t link = 0; link < linkForward.size(); link++) {
+        double forward = 0, backward = 0;
+        for (int s = linkBegin[link]; s < linkBegin[link + 1]; s++) {
+            int arc = segmentArcs[s], reverse = graph.getReverse(arc);
+            double cost = costs[arc], reverseCost = reverse != -1 ? costs[reverse] : 0;
+            forward += segmentSigns[s] > 0 ? cost : reverseCost;
+            backward += segmentSigns[s] > 0 ? reverseCost : cost;
+        }
+        if (linkForward[link] != -1)
+            reducedCosts[linkForward[link]] = forward;
+        if (linkBackward[link] != -1)
+            reducedCosts[linkBackward[link]] = backward;
+    }
+    return reducedCosts;
+}
+
+void FlowGraphReducer::expandFlows(const vector<double> &reducedFlows, vector<double> &flows) const {
+    flows.assign(graph.getNumArcs(), 0);
+    for (size_t link = 0; link < linkForward.size(); link++) {
+        double flow = linkForward[link] != -1 ? reducedFlows[linkForward[link]] : -reducedFlows[linkBackward[link]];
+        for (int s = linkBegin[link]; s < linkBegin[link + 1]; s++) {
+            int arc = segmentArcs[s], reverse = graph.getReverse(arc);
+            flows[arc] += segmentSigns[s] * flow;
+            if (reverse != -1)
+                flows[reverse] -= segmentSigns[s] * flow;
+        }
+    }
+}
+
+int FlowGraphReducer::getNumPrunedVertices() const {
+    return numPruned;
+}
+
+int FlowGraphReducer::getNumContractedVertices() const {
+    return numContracted;
+}
@@ -0,0 +1,121 @@
+#include "FlowKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FLOW_KERNELS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace FlowKernels {
+
+#ifdef FLOW_KERNELS_AVX2
+
+__attribute__((target("avx2")))
+static void zeroAvx2(double *values, size_t count) {
+    size_t i = 0;
+    __m256d zeros = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4)
+        _mm256_storeu_pd(values + i, zeros);
+    for (; i < count; i++)
+        values[i] = 0;
+}
+
+__attribute__((target("avx2")))
+static void residualsAvx2(const double *capacities, const double *flows, double *residuals, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm256_storeu_pd(residuals + i, _mm256_sub_pd(_mm256_loadu_pd(capacities + i), _mm256_loadu_pd(flows + i)));
+    for (; i < count; i++)
+        residuals[i] = capacities[i] - flows[i];
+}
+
+/**
+ * @brief Adds the four lanes of a vector
+ * @param v Vector to reduce
+ * @return Sum of the lanes
+ */
+__attribute__((target("avx2")))
+static double reduceAvx2(__m256d v) {
+    __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+__attribute__((target("avx2")))
+static double sumAvx2(const double *values, size_t count) {
+    size_t i = 0;
+    __m256d total = _mm256_setzero_pd();
+    for (; i + 4 <= count; i += 4)
+        total = _mm256_add_pd(total, _mm256_loadu_pd(values + i));
+    double result = reduceAvx2(total);
+    for (; i < count; i++)
+        result += values[i];
+    return result;
+}
+
+__attribute__((target("avx2")))
+static double sumIndexedAvx2(const double *values, const int *indexes, size_t count) {
+    size_t i = 0;
+    __m256d total = _mm256_setzero_pd(), all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    for (; i + 4 <= count; i += 4) {
+        __m128i gather = _mm_loadu_si128((const __m128i *)(indexes + i));
+        total = _mm256_add_pd(total, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), values, gather, all, 8));
+    }
+    double result = reduceAvx2(total);
+    for (; i < count; i++)
+        result += values[indexes[i]];
+    return result;
+}
+
+bool usesAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#else
+
+bool usesAvx2() {
+    return false;
+}
+
+#endif
+
+void zero(double *values, size_t count) {
+#ifdef FLOW_KERNELS_AVX2
+    if (usesAvx2())
+        return zeroAvx2(values, count);
+#endif
+    for (size_t i = 0; i < count; i++)
+        values[i] = 0;
+}
+
+void residuals(const double *capacities, const double *flows, double *residuals, size_t count) {
+#ifdef FLOW_KERNELS_AVX2
+    if (usesAvx2())
+        return residualsAvx2(capacities, flows, residuals, count);
+#endif
+    for (size_t i = 0; i < count; i++)
+        residuals[i] = capacities[i] - flows[i];
+}
+
+double sum(const double *values, size_t count) {
+#ifdef FLOW_KERNELS_AVX2
+    if (usesAvx2())
+        return sumAvx2(values, count);
+#endif
+    double result = 0;
+    for (size_t i = 0; i < count; i++)
+        result += values[i];
+    return result;
+}
+
+double sumIndexed(const double *values, const int *indexes, size_t count) {
+#ifdef FLOW_KERNELS_AVX2
+    if (usesAvx2())
+        return sumIndexedAvx2(values, indexes, count);
+#endif
+    double result = 0;
+    for (size_t i = 0; i < count; i++)
+        result += values[indexes[i]];
+    return result;
+}
+
+}
@@ -0,0 +1,169 @@
+#include "FlowSolver.h"
+#include "FlowKernels.h"
+
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+FlowSolver::FlowSolver(const FlowGraph &graph)
+        : graph(graph), flows(graph.getNumArcs(), 0), failed(graph.getNumArcs(), false),
+          capacities(graph.getCapacities()), parentArc(graph.getNumVertices(), -1),
+          parentDirect(graph.getNumVertices(), false),
+          visited(graph.getNumVertices(), 0), visitStamp(0), parallelBfs(graph, 1) {}
+
+const FlowGraph &FlowSolver::getGraph() const {
+    return graph;
+}
+
+void FlowSolver::resetFlows() {
+    FlowKernels::zero(flows.data(), flows.size());
+}
+
+void FlowSolver::setFlows(const vector<double> &flows) {
+    this->flows = flows;
+}
+
+const vector<double> &FlowSolver::getFlows() const {
+    return flows;
+}
+
+double FlowSolver::getFlow(int arc) const {
+    return flows[arc];
+}
+
+void FlowSolver::failArc(int arc) {
+    // The twin of an arc is unidirectional, so the arc, its reverse and its twin are all the directions of the pipe
+    for (int direction: {arc, graph.getReverse(arc), graph.getTwin(arc)}) {
+        if (direction != -1 && !failed[direction]) {
+            failed[direction] = true;
+            failedArcs.push_back(direction);
+        }
+    }
+}
+
+void FlowSolver::limitArc(int arc, double capacity) {
+    limitedArcs.push_back(arc);
+    capacities[arc] = capacity;
+}
+
+void FlowSolver::clearFailures() {
+    for (int arc: failedArcs)
+        failed[arc] = false;
+    failedArcs.clear();
+    for (int arc: limitedArcs)
+        capacities[arc] = graph.getCapacity(arc);
+    limitedArcs.clear();
+}
+
+void FlowSolver::selectPaths(const AugmentingPathPool &paths, int arc) {
+    for (auto it = paths.getPipePathsBegin(arc); it != paths.getPipePathsEnd(arc); it++) {
+        if (pathSelected[*it])
+            continue;
+        pathSelected[*it] = true;
+        selectedPaths.push_back((int)*it);
+    }
+}
+
+void FlowSolver::subtractPaths(const AugmentingPathPool &paths, const vector<int> &arcs) {
+    pathSelected.resize(paths.getNumPaths(), false);
+    for (int arc: arcs)
+        selectPaths(paths, arc);
+
+    // Paths selected in cascade are appended to the list, so they are also visited by this loop
+    for (size_t i = 0; i < selectedPaths.size(); i++) {
+        int path = selectedPaths[i];
+        double flowToRemove = paths.getCapacity(path);
+        for (uint32_t pos = paths.getPathBegin(path); pos < paths.getPathEnd(path); pos++) {
+            int arc = paths.getArcPipe(pos);
+            pushFlow(arc, !paths.isArcDirect(pos), flowToRemove);
+            int reverse = graph.getReverse(arc);
+            if ((reverse == -1 && flows[arc] < 0) || flows[arc] > capacities[arc]
+                || (reverse != -1 && flows[reverse] > capacities[reverse]))
+                selectPaths(paths, arc);
+        }
+    }
+
+    for (int path: selectedPaths)
+        pathSelected[path] = false;
+    selectedPaths.clear();
+}
+
+void FlowSolver::pushFlow(int arc, bool direct, double value) {
+    flows[arc] += direct ? value : -value;
+    int reverse = graph.getReverse(arc);
+    if (reverse != -1)
+        flows[reverse] -= direct ? value : -value;
+}
+
+void FlowSolver::setBfsThreads(unsigned numThreads) {
+    parallelBfs.setNumThreads(numThreads);
+}
+
+bool FlowSolver::bfs() {
+    if (parallelBfs.isWorthIt())
+        return parallelBfs.search(flows, capacities, failed, parentArc, parentDirect);
+
+    int source = graph.getSource(), sink = graph.getSink();
+    if (++visitStamp == 0) {
+        visited.assign(visited.size(), 0);
+        visitStamp = 1;
+    }
+
+    queue.clear();
+    queue.push_back(source);
+    visited[source] = visitStamp;
+    for (size_t head = 0; head < queue.size() && visited[sink] != visitStamp; head++) {
+        int u = queue[head];
+        for (int pos = graph.getOutBegin(u); pos < graph.getOutEnd(u); pos++) {
+            int arc = graph.getOutArc(pos), v = graph.getHead(arc);
+            if (failed[arc] || visited[v] == visitStamp || capacities[arc] - flows[arc] <= 0)
+                continue;
+            visited[v] = visitStamp;
+            parentArc[v] = arc;
+            parentDirect[v] = true;
+            queue.push_back(v);
+        }
+        for (int pos = graph.getInBegin(u); pos < graph.getInEnd(u); pos++) {
+            int arc = graph.getInArc(pos), v = graph.getTail(arc);
+            if (failed[arc] || visited[v] == visitStamp || flows[arc] <= 0)
+                continue;
+            visited[v] = visitStamp;
+            parentArc[v] = arc;
+            parentDirect[v] = false;
+            queue.push_back(v);
+        }
+    }
+    return visited[sink] == visitStamp;
+}
+
+double FlowSolver::augment() {
+    int source = graph.getSource(), sink = graph.getSink();
+    if (source == sink)
+        return 0;
+
+    double added = 0;
+    while (bfs()) {
+        double capacity = numeric_limits<double>::infinity();
+        for (int v = sink; v != source; ) {
+            int arc = parentArc[v];
+            capacity = min(capacity, parentDirect[v] ? capacities[arc] - flows[arc] : flows[arc]);
+            v = parentDirect[v] ? graph.getTail(arc) : graph.getHead(arc);
+        }
+        for (int v = sink; v != source; ) {
+            int arc = parentArc[v];
+            pushFlow(arc, parentDirect[v], capacity);
+            v = parentDirect[v] ? graph.getTail(arc) : graph.getHead(arc);
+        }
+        added += capacity;
+    }
+    return added;
+}
+
+double FlowSolver::getFlowValue() const {
+    return getInflow(graph.getSink());
+}
+
+double FlowSolver::getInflow(int v) const {
+    return graph.getInflow(flows, v);
+}
@@ -1,23 +1,47 @@
 #include "Interface.h"
 #include "input.h"
 #include "ansi.h"
+#include "StationOutlet.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <codecvt>
 #include <algorithm>
-#include <fstream>
 #include <cmath>
 
 using namespace std;
 
+/**
+ * @brief Returns the total supply of the cities in a scenario of a store
+ * @param store Store of the scenario
+ * @param row Index of the scenario
+ * @return Sum of the supplies of the cities in the scenario
+ */
+static double getScenarioFlow(const ScenarioResultStore &store, size_t row) {
+    double flow = 0;
+    for (int column = 0; column < store.getNumCities(); column++)
+        flow += store.getSupply(row, column);
+    return flow;
+}
+
+/**
+ * @brief Returns the number of cities that have less supply in a scenario of a store than in its baseline
+ * @param store Store of the scenario
+ * @param row Index of the scenario
+ * @return Number of cities with less supply
+ */
+static int countShortCities(const ScenarioResultStore &store, size_t row) {
+    int count = 0;
+    for (int column = 0; column < store.getNumCities(); column++)
+        count += store.getSupply(row, column) < store.getBaseline()[column];
+    return count;
+}
+
 bool Interface::init(){
     this->wsn = WaterSupplyNetwork();
     if (!datasetMenu())
         return false;
-    std::ofstream ofs;
-    ofs.open(fileName, std::ofstream::out | std::ofstream::trunc);
-    ofs.close();
+    report.open(fileName + ReportWriter::getExtension(outputFormat), outputFormat);
     clearScreen();
     return true;
 }
@@ -194,6 +218,7 @@ void Interface::waitInput() {
         press = getNextPress();
     } while  (press != RET);
     endCapture();
+    report.flush();
 }
 
 void Interface::printTitle(const std::string &title) {
@@ -232,69 +257,141 @@ void Interface::printHiddenPipes() {
 }
 
 void Interface::saveGeneralMaxFlowToFile(const std::string& title) {
-    std::ofstream output;
-    output.open(fileName, std::ios::app);
-    output << "===>  " << title << '\n';
+    report.beginSection(title, {"city", "flow"});
     for (auto c : wsn.getDeliverySites()){
-        output << c->getDescription() << ',' << cityToDefaultFlow[c->getCity()] << '\n';
+        report.writeRow({c->getDescription(), cityToDefaultFlow[c->getCity()]});
     }
-    output.close();
+    report.endSection();
 }
 
 void Interface::saveAllMaxFlowToFile(const std::string& title) {
-    std::ofstream output;
-    output.open(fileName, std::ios::app);
-    output << "===>  " << title << '\n';
+    report.beginSection(title, {"city", "normal_flow", "flow", "difference"});
     for (auto c : wsn.getDeliverySites()){
         double diff = c->getSupplyRate() - cityToDefaultFlow[c->getCity()];
-        output << c->getDescription() << ',' << cityToDefaultFlow[c->getCity()] << ',' << c->getSupplyRate() << ',' << diff << '\n';
+        report.writeRow({c->getDescription(), cityToDefaultFlow[c->getCity()], c->getSupplyRate(), diff});
     }
-    output.close();
+    report.endSection();
 }
 
 void Interface::saveSingleMaxFlowToFile(const DeliverySite* city, const std::string& title) {
-    std::ofstream output;
-    output.open(fileName);
-    output << "===>  " << title << '\n';
-    output << city->getDescription() << ',' << city->getSupplyRate() << '\n';
-    output.close();
+    report.beginSection(title, {"city", "flow"});
+    report.writeRow({city->getDescription(), city->getSupplyRate()});
+    report.endSection();
 }
 
 void Interface::saveDeficitsToFile(const std::string& title) {
-    std::ofstream output;
-    output.open(fileName, std::ios::app);
-    output << "===>  " << title << '\n';
+    report.beginSection(title, {"city", "demand", "flow", "deficit"});
     for (auto c : wsn.getDeliverySites()){
         double diff = c->getDemand() - c->getSupplyRate();
         if (diff != 0){
-            output << c->getDescription() << ',' << c->getDemand() << ',' << c->getSupplyRate() << ',' << diff << '\n';
+            report.writeRow({c->getDescription(), c->getDemand(), c->getSupplyRate(), diff});
         }
     }
-    output.close();
+    report.endSection();
 }
 
 void Interface::saveCriticalPipesToFile(const std::string& title, const std::vector<Pipe *> pipes) {
-    std::ofstream output;
-    output.open(fileName, std::ios::app);
-    output << "===>  " << title << '\n';
+    report.beginSection(title, {"source", "destination"});
     for (auto p : pipes){
-        output << p->getOrig()->getCode() << ',' << p->getDest()->getCode() << '\n';
+        report.writeRow({p->getOrig()->getCode(), p->getDest()->getCode()});
+    }
+    report.endSection();
+}
+
+void Interface::saveWorstFailuresToFile(const std::string& title, const FailureReport &failureReport) {
+    std::string worstFlowFailures;
+    for (const std::string &failure : failureReport.worstFlowFailures){
+        if (!worstFlowFailures.empty()){
+            worstFlowFailures += ';';
+        }
+        worstFlowFailures += failure;
+    }
+    report.beginSection(title + " (Total)", {"normal_flow", "worst_flow", "deficit", "failures"});
+    report.writeRow({failureReport.normalFlow, failureReport.worstFlow, failureReport.normalFlow - failureReport.worstFlow,
+                     worstFlowFailures});
+    report.endSection();
+
+    // The supplies of the cities are the ones of one max flow of each combination (see FailureScenarioEngine)
+    report.beginSection(title, {"city", "normal_flow", "worst_flow", "failures"});
+    for (const CityFailureReport &cityReport : failureReport.cities){
+        if (cityReport.worstSupply >= cityReport.normalSupply){
+            continue;
+        }
+        std::string failures;
+        for (const std::string &failure : cityReport.failures){
+            if (!failures.empty()){
+                failures += ';';
+            }
+            failures += failure;
+        }
+        report.writeRow({cityReport.city->getDescription(), cityReport.normalSupply, cityReport.worstSupply, failures});
     }
-    output.close();
+    report.endSection();
 }
 
 void Interface::saveMetricsToFile(std::tuple<double, double, double> &metrics) {
-    std::ofstream output;
-    output.open(fileName, std::ios::app);
-    output << get<0>(metrics) << ',' << get<1>(metrics) << ',' << get<2>(metrics) << '\n';
-    output.close();
+    report.writeRow({get<0>(metrics), get<1>(metrics), get<2>(metrics)});
+}
+
+void Interface::saveMinCostFlowToFile(const std::string& title, double flow, double cost) {
+    report.beginSection(title, {"city", "flow"});
+    for (auto c : wsn.getDeliverySites()){
+        report.writeRow({c->getDescription(), c->getSupplyRate()});
+    }
+    report.endSection();
+    report.beginSection(title + " (Total)", {"flow", "cost"});
+    report.writeRow({flow, cost});
+    report.endSection();
+}
+
+void Interface::saveDemandBreakpointsToFile(const std::string& title, const std::vector<std::pair<DeliverySite*, double>> &breakpoints) {
+    report.beginSection(title, {"city", "demand", "factor"});
+    for (const auto &breakpoint : breakpoints){
+        report.writeRow({breakpoint.first->getDescription(), breakpoint.first->getDemand(), breakpoint.second});
+    }
+    report.endSection();
+}
+
+void Interface::saveReservoirOutagesToFile(const std::string& title, const ScenarioResultStore &outages, const ScenarioResultStore &droughts) {
+    report.beginSection(title, {"reservoir", "outage_flow", "outage_cities_short", "drought_flow", "drought_cities_short"});
+    for (size_t row = 0; row < outages.getNumScenarios(); row++){
+        Reservoir *reservoir = wsn.findReservoir(outages.getScenarioName(row));
+        report.writeRow({reservoir->getDescription(), getScenarioFlow(outages, row), (double)countShortCities(outages, row),
+                         getScenarioFlow(droughts, row), (double)countShortCities(droughts, row)});
+    }
+    report.endSection();
 }
 
-void Interface::saveTitleToFile(const std::string &title) {
-    std::ofstream output;
-    output.open(fileName, std::ios::app);
-    output << "===>  " << title << '\n';
-    output.close();
+void Interface::saveStationDegradationsToFile(const std::string& title, const ScenarioResultStore &degradations) {
+    report.beginSection(title, {"station", "throughput", "degraded_flow", "cities_short"});
+    for (size_t row = 0; row < degradations.getNumScenarios(); row++){
+        PumpingStation *station = wsn.findPumpingStation(degradations.getScenarioName(row));
+        report.writeRow({station->getDescription(), station->getInflow(), getScenarioFlow(degradations, row),
+                         (double)countShortCities(degradations, row)});
+    }
+    report.endSection();
+}
+
+void Interface::saveFailureBenchmarkToFile(const std::string& title, const FailureBenchmark &benchmark) {
+    report.beginSection(title, {"kind", "element", "incremental_flow", "brute_force_flow", "incremental_time",
+                                "brute_force_time", "diverges"});
+    for (const BenchmarkCase &benchmarkCase : benchmark.getCases()){
+        report.writeRow({benchmarkCase.kind, benchmarkCase.description, benchmarkCase.incrementalFlow,
+                         benchmarkCase.bruteForceFlow, benchmarkCase.incrementalTime, benchmarkCase.bruteForceTime,
+                         (double)benchmarkCase.diverges});
+    }
+    report.endSection();
+    report.beginSection(title + " (Summary)", {"kind", "cases", "divergent", "incremental_time", "brute_force_time",
+                                               "p50_speedup", "p99_speedup"});
+    for (const BenchmarkSummary &summary : benchmark.getSummaries()){
+        report.writeRow({summary.kind, (double)summary.numCases, (double)summary.numDivergent, summary.incrementalTime,
+                         summary.bruteForceTime, summary.medianSpeedup, summary.p99Speedup});
+    }
+    report.endSection();
+}
+
+void Interface::saveTitleToFile(const std::string &title, const std::vector<std::string> &columns) {
+    report.beginSection(title, columns);
 }
 
 void Interface::mainMenu() {
@@ -312,9 +409,18 @@ void Interface::mainMenu() {
              "Test Pipe Failures",
              "Test Pipe Failures (Brute-Force)",
              "Critical Pipes for Specific City",
+             "Worst Combined Failures (N-k)",
+             "Export All Single Failures (Columnar)",
              "Network Balancing",
+             "Minimum Pumping Cost Max Flow",
+             "Time Series Simulation (Columnar)",
+             "Demand Growth Until Deficit",
+             "Reservoir Outages and Droughts (All Reservoirs)",
+             "Pumping Station Degradations (All Stations)",
+             "Benchmark Incremental vs Brute-Force Failures",
              "Display Network Information",
-             outputToFile ? "Set output to Console" : "Set output to File (output.txt)",
+             outputToFile ? "Set output to Console" : "Set output to File (output" + ReportWriter::getExtension(outputFormat) + ")",
+             "Change output format (" + ReportWriter::getFormatName(outputFormat) + ")",
              "Choose your operation:"};
 
 
@@ -631,16 +737,49 @@ void Interface::mainMenu() {
             break;
         }
         case 11:{
-            wsn.loadCachedMaxFlow();
-            std::vector<std::tuple<double, double, double>> allMetrics;
-            std::tuple<double, double, double> metrics;
-            wsn.getMetrics(metrics);
-            allMetrics.push_back(metrics);
-            int attempts = 5;
-
+            if (cityToDefaultFlow.empty()){
+                defaultNetworkFlow = wsn.loadCachedMaxFlow();
+                for (DeliverySite *ds : wsn.getDeliverySites()){
+                    cityToDefaultFlow[ds->getCity()] = ds->getSupplyRate();
+                }
+            }
+            int k = failureCountMenu();
+            if (k == 0){
+                break;
+            }
+            FailureReport report = wsn.getWorstFailures(k);
+            std::string title = "Worst Combined Failures (N-" + to_string(k) + ")";
+            if (outputToFile){
+                saveWorstFailuresToFile(title, report);
+            }
+            else {
+                printTitle(title);
+                displayWorstFailures(report);
+                printNetworkFlow(report.worstFlow);
+            }
+            waitInput();
+            break;
+        }
+        case 12:{
+            ScenarioResultStore store;
+            wsn.sweepFailures(store);
+            bool saved = store.save(sweepFileName);
+            printTitle("Export All Single Failures (Columnar)");
+            if (saved){
+                cout << std::string(infoSpacing, ' ') << "Saved " << BOLD << store.getNumScenarios() << RESET
+                     << " failures for " << BOLD << store.getNumCities() << RESET << " cities to "
+                     << CYAN << sweepFileName << RESET << '\n';
+            }
+            else {
+                cout << std::string(infoSpacing, ' ') << RED << "Could not write to " << sweepFileName << RESET << '\n';
+            }
+            waitInput();
+            break;
+        }
+        case 13:{
             std::string title = "Balancing Metrics";
             if (outputToFile){
-                saveTitleToFile(title);
+                saveTitleToFile(title, {"max_difference", "mean_difference", "variance"});
             }
             else {
                 title.append(" (this may take a while)");
@@ -648,38 +787,134 @@ void Interface::mainMenu() {
                 printMetricsHeader();
             }
 
-            std::tuple<double, double, double> prevMetrics;
-            do {
+            BalanceProgress result = wsn.balance(balanceTimeBudget, [&](const BalanceProgress &progress){
+                std::tuple<double, double, double> metrics = progress.metrics;
                 if (outputToFile){
                     saveMetricsToFile(metrics);
                 }
                 else {
                     printMetricsRow(metrics);
                 }
-                wsn.balance(get<1>(metrics));
-                prevMetrics = metrics;
-                wsn.getMetrics(metrics);
-                allMetrics.push_back(metrics);
-                attempts--;
-            } while (abs(get<2>(prevMetrics) - get<2>(metrics)) > (0.001 * get<2>(prevMetrics)) && attempts > 0);
+            });
 
             if (outputToFile){
-                saveMetricsToFile(metrics);
+                report.endSection();
             }
             else {
-                printMetricsRow(metrics);
                 printBottom();
+                cout << std::string(infoSpacing, ' ') << "Cycles Balanced: " << BOLD << result.cyclesCancelled << RESET
+                     << FAINT << " (" << (long)(result.elapsedSeconds * 1000) << " ms)" << RESET << '\n';
             }
 
             waitInput();
             break;
         }
-        case 12:
+        case 14:{
+            double cost;
+            double networkFlow = wsn.getMinCostMaxFlow(cost);
+            std::string title = "Minimum Pumping Cost Max Flow";
+            if (outputToFile){
+                saveMinCostFlowToFile(title, networkFlow, cost);
+            }
+            else {
+                printTitle(title);
+                cityDisplay(wsn.getDeliverySites());
+                printNetworkFlow(networkFlow, false);
+                cout << std::string(infoSpacing, ' ') << "Total Pumping Cost: " << BOLD << cost << RESET << '\n';
+            }
+            waitInput();
+            break;
+        }
+        case 15:{
+            TimeProfile profile;
+            ScenarioResultStore store;
+            printTitle("Time Series Simulation (Columnar)");
+            if (!profile.load(profileFileName)){
+                cout << std::string(infoSpacing, ' ') << RED << "Could not read the profile " << profileFileName << RESET << '\n';
+            }
+            else if (!wsn.simulateTimeSeries(profile, store)){
+                cout << std::string(infoSpacing, ' ') << RED << "The profile has codes that are not of cities or reservoirs"
+                     << RESET << '\n';
+            }
+            else if (store.save(timeSeriesFileName)){
+                cout << std::string(infoSpacing, ' ') << "Saved " << BOLD << store.getNumScenarios() << RESET
+                     << " steps for " << BOLD << store.getNumCities() << RESET << " cities to "
+                     << CYAN << timeSeriesFileName << RESET << '\n';
+            }
+            else {
+                cout << std::string(infoSpacing, ' ') << RED << "Could not write to " << timeSeriesFileName << RESET << '\n';
+            }
+            waitInput();
+            break;
+        }
+        case 16:{
+            std::vector<std::pair<DeliverySite*, double>> breakpoints = wsn.getDemandBreakpoints();
+            std::string title = "Demand Growth Until Deficit";
+            if (outputToFile){
+                saveDemandBreakpointsToFile(title, breakpoints);
+            }
+            else {
+                printTitle(title);
+                displayDemandBreakpoints(breakpoints);
+            }
+            waitInput();
+            break;
+        }
+        case 17:{
+            ScenarioResultStore outages, droughts;
+            wsn.sweepReservoirOutages(outages);
+            wsn.sweepReservoirOutages(droughts, droughtCapacityFactor);
+            std::string title = "Reservoir Outages and Droughts (" + to_string((int)round(droughtCapacityFactor * 100))
+                                + "% of the Delivery)";
+            if (outputToFile){
+                saveReservoirOutagesToFile(title, outages, droughts);
+            }
+            else {
+                printTitle(title);
+                displayReservoirOutages(outages, droughts);
+            }
+            waitInput();
+            break;
+        }
+        case 18:{
+            ScenarioResultStore degradations;
+            wsn.sweepStationDegradations(degradations, stationDegradationFactor);
+            std::string title = "Pumping Station Degradations (" + to_string((int)round(stationDegradationFactor * 100))
+                                + "% of the Capacity)";
+            if (outputToFile){
+                saveStationDegradationsToFile(title, degradations);
+            }
+            else {
+                printTitle(title);
+                displayStationDegradations(degradations);
+            }
+            waitInput();
+            break;
+        }
+        case 19:{
+            FailureBenchmark benchmark(wsn);
+            benchmark.run();
+            std::string title = "Incremental vs Brute-Force Failures";
+            if (outputToFile){
+                saveFailureBenchmarkToFile(title, benchmark);
+            }
+            else {
+                printTitle(title);
+                displayFailureBenchmark(benchmark);
+            }
+            waitInput();
+            break;
+        }
+        case 20:
             informationMenu();
             break;
-        case 13:
+        case 21:
             outputToFile = not outputToFile;
             break;
+        case 22:
+            outputFormat = (ReportFormat)((outputFormat + 1) % (REPORT_BINARY + 1));
+            report.open(fileName + ReportWriter::getExtension(outputFormat), outputFormat);
+            break;
         case 0:
             exitMenu();
             break;
@@ -696,6 +931,7 @@ void Interface::informationMenu() {
              "List All Reservoirs",
              "List All Pumping Stations",
              "List Pipes from Service Point",
+             "Network Structure",
              "Information to check:"
             };
 
@@ -740,6 +976,11 @@ void Interface::informationMenu() {
             waitInput();
             break;
         }
+        case 5:
+            printTitle("Network Structure");
+            networkStructureDisplay();
+            waitInput();
+            break;
         default:
             mainMenu();
     }
@@ -789,6 +1030,33 @@ bool Interface::pipeMenu() {
     return false;
 }
 
+int Interface::failureCountMenu() {
+    initCapture();
+    std::cout << HIDE_CURSOR;
+    std::vector<std::string> options =
+            {"Back",
+             "Single Failures (N-1)",
+             "Pairs of Failures (N-2)",
+             "Triples of Failures (N-3, this may take a while)",
+             "Choose the maximum number of simultaneous failures:"};
+
+    int choice = 1;
+    Press press;
+    do {
+        clearScreen();
+        printTop();
+        printMenuOptions(options, choice);
+        printBottom();
+        press = getNextPress();
+        if (press == UP) {choice -= 1; choice += (options.size()-1);}
+        else if (press == DOWN) {choice += 1;}
+        choice = choice % (options.size()-1);
+    } while (press != RET);
+
+    endCapture();
+    return choice;
+}
+
 bool Interface::datasetMenu() {
     initCapture();
     std::cout << HIDE_CURSOR;
@@ -982,7 +1250,7 @@ ServicePoint * Interface::servicePointSelection() {
     std::vector<std::string> options =
             {"Back"};
     for (ServicePoint* sp : getSortedServicePoints()){
-        if (sp->getId() == 0){
+        if (sp->getId() == 0 || dynamic_cast<StationOutlet *>(sp) != nullptr){
             continue;
         }
         if (sp->getAdj().size() == 1){
@@ -1023,6 +1291,11 @@ ServicePoint * Interface::servicePointSelection(ServicePoint *src) {
     std::cout << HIDE_CURSOR;
     std::vector<std::string> options =
             {"Back"};
+    // The outgoing pipes of a pumping station with a throughput limit leave from its outlet
+    auto *station = dynamic_cast<PumpingStation *>(src);
+    if (station != nullptr && station->getOutlet() != nullptr){
+        src = station->getOutlet();
+    }
     for (Pipe *p : src->getAdj()){
         ServicePoint *sp = p->getDest();
         options.push_back(sp->getCode());
@@ -1162,24 +1435,31 @@ void Interface::reservoirDisplay(const std::vector<Reservoir*> &reservoirs) {
 }
 
 void Interface::pumpingStationDisplay(const std::vector<PumpingStation *> &pumpingStations) {
-    vector<int> colLens = {37, 37};
-    vector<string> headers = {"Code", "Id"};
+    vector<int> colLens = {25, 24, 24};
+    vector<string> headers = {"Code", "Id", "Capacity"};
     vector<vector<string>> cells(pumpingStations.size(), vector<string>());
     for (int i = 0; i < pumpingStations.size(); i++) {
         const PumpingStation *pumpingStation = pumpingStations[i];
-        cells[i] = {pumpingStation->getCode(), doubleToString(pumpingStation->getId())};
+        cells[i] = {pumpingStation->getCode(), doubleToString(pumpingStation->getId()),
+                    std::isinf(pumpingStation->getCapacity()) ? "-" : doubleToString(pumpingStation->getCapacity())};
     }
     printTable(colLens, headers, cells);
 }
 
 void Interface::pipeDisplay(const ServicePoint *servicePoint) {
+    const ServicePoint *outlet = servicePoint;
+    auto *station = dynamic_cast<const PumpingStation *>(servicePoint);
+    if (station != nullptr && station->getOutlet() != nullptr) {
+        outlet = station->getOutlet();
+    }
+
     printTitleNoClear("Outgoing pipes");
     vector<int> colLens = {25, 24, 24};
     vector<string> headers = {"Destination", "Bidirectional", "Capacity"};
-    vector<vector<string>> cells(servicePoint->getAdj().size(), vector<string>());
-    for (int i = 0; i < servicePoint->getAdj().size(); i++) {
-        Pipe *pipe = servicePoint->getAdj()[i];
-        cells[i] = {pipe->getDest()->getDescription(), pipe->getReverse() == nullptr ? "No" : "Yes", doubleToString(pipe->getCapacity())};
+    vector<vector<string>> cells(outlet->getAdj().size(), vector<string>());
+    for (int i = 0; i < outlet->getAdj().size(); i++) {
+        Pipe *pipe = outlet->getAdj()[i];
+        cells[i] = {pipe->getDest()->getDescription(), pipe->isBidirectional() ? "Yes" : "No", doubleToString(pipe->getCapacity())};
     }
     printTable(colLens, headers, cells);
 
@@ -1189,7 +1469,57 @@ void Interface::pipeDisplay(const ServicePoint *servicePoint) {
     cells = vector<vector<string>>(servicePoint->getIncoming().size(), vector<string>());
     for(int i = 0; i < servicePoint->getIncoming().size(); i++) {
         Pipe *pipe = servicePoint->getIncoming()[i];
-        cells[i] = {pipe->getOrig()->getDescription(), pipe->getReverse() == nullptr ? "No" : "Yes", doubleToString(pipe->getCapacity())};
+        cells[i] = {pipe->getOrig()->getDescription(), pipe->isBidirectional() ? "Yes" : "No", doubleToString(pipe->getCapacity())};
+    }
+    printTable(colLens, headers, cells);
+}
+
+void Interface::networkStructureDisplay() {
+    vector<double> componentFlows = wsn.getComponentFlows();
+    vector<int> numReservoirs(componentFlows.size(), 0), numStations(componentFlows.size(), 0),
+            numCities(componentFlows.size(), 0);
+    for (Reservoir *reservoir: wsn.getReservoirs())
+        numReservoirs[wsn.getComponent(reservoir)]++;
+    for (PumpingStation *station: wsn.getPumpingStations())
+        numStations[wsn.getComponent(station)]++;
+    for (DeliverySite *city: wsn.getDeliverySites())
+        numCities[wsn.getComponent(city)]++;
+
+    printTitleNoClear("Components");
+    vector<int> colLens = {11, 11, 11, 11, 11, 11};
+    vector<string> headers = {"Component", "Reservoirs", "Stations", "Cities", "Max Flow", "Share"};
+    double maxFlow = 0;
+    for (double flow: componentFlows)
+        maxFlow += flow;
+    vector<vector<string>> cells(componentFlows.size(), vector<string>());
+    for (size_t i = 0; i < componentFlows.size(); i++) {
+        cells[i] = {to_string(i + 1), to_string(numReservoirs[i]), to_string(numStations[i]), to_string(numCities[i]),
+                    doubleToString(componentFlows[i]),
+                    maxFlow > 0 ? doubleToString(componentFlows[i] / maxFlow * 100) + "%" : "-"};
+    }
+    printTable(colLens, headers, cells);
+
+    printTitleNoClear("Service points whose failure splits a component");
+    vector<ServicePoint*> articulationPoints = wsn.getArticulationPoints();
+    colLens = {25, 24, 24};
+    headers = {"Service Point", "Component", "Flow Through"};
+    cells = vector<vector<string>>(articulationPoints.size(), vector<string>());
+    for (size_t i = 0; i < articulationPoints.size(); i++) {
+        ServicePoint *sp = articulationPoints[i];
+        cells[i] = {sp->getDescription(), to_string(wsn.getComponent(sp) + 1),
+                    doubleToString(sp->getInflow())};
+    }
+    printTable(colLens, headers, cells);
+
+    printTitleNoClear("Pipes whose failure splits a component");
+    vector<Pipe*> bridges = wsn.getBridgePipes();
+    colLens = {25, 24, 24};
+    headers = {"Origin", "Destination", "Capacity"};
+    cells = vector<vector<string>>(bridges.size(), vector<string>());
+    for (size_t i = 0; i < bridges.size(); i++) {
+        Pipe *pipe = bridges[i];
+        cells[i] = {pipe->getOrig()->getDescription(), pipe->getDest()->getDescription(),
+                    doubleToString(pipe->getCapacity())};
     }
     printTable(colLens, headers, cells);
 }
@@ -1269,12 +1599,146 @@ void Interface::displayCriticalPipes(const std::vector<Pipe *> &pipes) {
     vector<vector<string>> cells;
     for (const Pipe *p : pipes) {
         cells.push_back({p->getOrig()->getDescription(), p->getDest()->getDescription(),
-                         p->getReverse() == nullptr ? "No" : "Yes", doubleToString(p->getCapacity())});
+                         p->isBidirectional() ? "Yes" : "No", doubleToString(p->getCapacity())});
+    }
+    printTable(colLens, headers, cells);
+}
+
+void Interface::displayWorstFailures(const FailureReport &report) {
+    vector<int> colLens = {6, 18, 8, 8, 32};
+    vector<string> headers = {"Code", "City", "Normal", "Worst", "Failures"};
+    vector<vector<string>> cells;
+    auto describe = [](const vector<string> &combination) {
+        string failures;
+        for (const string &failure : combination) {
+            if (!failures.empty()) {
+                failures += ' ';
+            }
+            // Arrows are written with a single multibyte character, so that printTable aligns the columns
+            string description = failure;
+            size_t pos = description.find("<->");
+            if (pos != string::npos) {
+                description.replace(pos, 3, "↔");
+            }
+            pos = description.find("->");
+            if (pos != string::npos) {
+                description.replace(pos, 2, "→");
+            }
+            failures += description;
+        }
+        return failures;
+    };
+    for (const CityFailureReport &cityReport : report.cities) {
+        if (cityReport.worstSupply >= cityReport.normalSupply) {
+            continue;
+        }
+        cells.push_back({cityReport.city->getCode(), cityReport.city->getCity(), doubleToString(cityReport.normalSupply),
+                         doubleToString(cityReport.worstSupply), describe(cityReport.failures)});
+    }
+    if (cells.empty()) {
+        cout << std::string(infoSpacing, ' ') << "There are " << BOLD << YELLOW << "no" << RESET << " cities affected!\n";
+    }
+    else {
+        printTable(colLens, headers, cells);
+        // Only the total is exact: the supplies of the cities are the ones of one max flow of each combination
+        cout << std::string(infoSpacing, ' ') << FAINT << "City supplies are taken from one max flow of each combination"
+             << RESET << '\n';
+    }
+    cout << std::string(infoSpacing, ' ') << "Largest flow deficit: " << BOLD << YELLOW
+         << doubleToString(report.normalFlow - report.worstFlow) << RESET;
+    if (!report.worstFlowFailures.empty()) {
+        cout << FAINT << " (" << describe(report.worstFlowFailures) << ')' << RESET;
+    }
+    cout << '\n';
+    cout << std::string(infoSpacing, ' ') << "Combinations: " << BOLD << report.numCombinations << RESET
+         << FAINT << " (" << report.numPruned << " pruned, " << report.numEvaluated << " evaluated)" << RESET << '\n';
+}
+
+void Interface::displayDemandBreakpoints(const std::vector<std::pair<DeliverySite*, double>> &breakpoints) {
+    vector<int> colLens = {6, 18, 8, 8, 10};
+    vector<string> headers = {"Code", "City", "Demand", "Factor", "Growth"};
+    vector<vector<string>> cells;
+    for (const auto &breakpoint : breakpoints) {
+        DeliverySite *city = breakpoint.first;
+        if (std::isinf(breakpoint.second)) {
+            cells.push_back({city->getCode(), city->getCity(), doubleToString(city->getDemand()), "-", "-"});
+            continue;
+        }
+        cells.push_back({city->getCode(), city->getCity(), doubleToString(city->getDemand()),
+                         doubleToString(breakpoint.second), doubleToString((breakpoint.second - 1) * 100) + "%"});
+    }
+    printTable(colLens, headers, cells);
+    if (!breakpoints.empty() && !std::isinf(breakpoints.front().second)) {
+        cout << std::string(infoSpacing, ' ') << "Saturation point: " << BOLD << doubleToString(breakpoints.front().second)
+             << RESET << FAINT << " (" << breakpoints.front().first->getCode() << " is the first city that may be short)"
+             << RESET << '\n';
+    }
+}
+
+void Interface::displayReservoirOutages(const ScenarioResultStore &outages, const ScenarioResultStore &droughts) {
+    vector<int> colLens = {6, 24, 10, 10, 10, 8};
+    vector<string> headers = {"Code", "Reservoir", "Delivery", "Outage", "Drought", "Short"};
+    vector<vector<string>> cells;
+    for (size_t row = 0; row < outages.getNumScenarios(); row++) {
+        Reservoir *reservoir = wsn.findReservoir(outages.getScenarioName(row));
+        cells.push_back({reservoir->getCode(), reservoir->getName(), doubleToString(reservoir->getMaxDelivery()),
+                         doubleToString(getScenarioFlow(outages, row)), doubleToString(getScenarioFlow(droughts, row)),
+                         to_string(countShortCities(outages, row))});
     }
     printTable(colLens, headers, cells);
+    double normalFlow = 0;
+    for (double supply : outages.getBaseline()) {
+        normalFlow += supply;
+    }
+    cout << std::string(infoSpacing, ' ') << "Normal Flow: " << BOLD << doubleToString(normalFlow) << RESET
+         << FAINT << " (Short: cities with less water in the outage)" << RESET << '\n';
+}
+
+void Interface::displayStationDegradations(const ScenarioResultStore &degradations) {
+    vector<int> colLens = {8, 14, 14, 14, 10};
+    vector<string> headers = {"Code", "Capacity", "Throughput", "Degraded", "Short"};
+    vector<vector<string>> cells;
+    for (size_t row = 0; row < degradations.getNumScenarios(); row++) {
+        PumpingStation *station = wsn.findPumpingStation(degradations.getScenarioName(row));
+        cells.push_back({station->getCode(), std::isinf(station->getCapacity()) ? "-" : doubleToString(station->getCapacity()),
+                         doubleToString(station->getInflow()), doubleToString(getScenarioFlow(degradations, row)),
+                         to_string(countShortCities(degradations, row))});
+    }
+    printTable(colLens, headers, cells);
+    cout << std::string(infoSpacing, ' ') << FAINT << "Throughput in the normal flow, network flow with the station degraded"
+         << RESET << '\n';
+}
+
+void Interface::displayFailureBenchmark(const FailureBenchmark &benchmark) {
+    vector<int> colLens = {10, 7, 9, 12, 12, 9, 9};
+    vector<string> headers = {"Kind", "Cases", "Diverged", "Incr. (ms)", "BF (ms)", "p50", "p99"};
+    vector<vector<string>> cells;
+    for (const BenchmarkSummary &summary : benchmark.getSummaries()) {
+        cells.push_back({summary.kind, to_string(summary.numCases), to_string(summary.numDivergent),
+                         doubleToString(summary.incrementalTime * 1000), doubleToString(summary.bruteForceTime * 1000),
+                         doubleToString(summary.medianSpeedup, 3) + "x", doubleToString(summary.p99Speedup, 3) + "x"});
+    }
+    printTable(colLens, headers, cells);
+    cout << std::string(infoSpacing, ' ') << FAINT << "Speedup percentiles of the brute-force time over the incremental time"
+         << RESET << '\n';
+
+    vector<vector<string>> divergent;
+    for (const BenchmarkCase &benchmarkCase : benchmark.getCases()) {
+        if (benchmarkCase.diverges) {
+            divergent.push_back({benchmarkCase.kind, benchmarkCase.description,
+                                 doubleToString(benchmarkCase.incrementalFlow), doubleToString(benchmarkCase.bruteForceFlow)});
+        }
+    }
+    if (divergent.empty()) {
+        cout << std::string(infoSpacing, ' ') << "Divergent Totals: " << BOLD << GREEN << "None" << RESET << '\n';
+        return;
+    }
+    cout << std::string(infoSpacing, ' ') << "Divergent Totals: " << BOLD << RED << divergent.size() << RESET << '\n';
+    printTable({10, 30, 14, 14}, {"Kind", "Element", "Incremental", "Brute-Force"}, divergent);
 }
 
 void Interface::exitMenu() {
     std::cout << "Closing the app...\n";
+    report.close();
     exit(0);
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "MetricsAccumulator.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Ratio between the limits of a bucket of the sketch, for a relative error of 1%
+ */
+static const double SKETCH_GAMMA = 1.01 / 0.99;
+
+/**
+ * @brief Values with an absolute value smaller than this are placed in the bucket of zero
+ */
+static const double SKETCH_MIN_VALUE = 1e-9;
+
+MetricsAccumulator::MetricsAccumulator() : count(0), mean(0), m2(0), maxValue(0), maxValid(true) {}
+
+void MetricsAccumulator::reset(size_t numKeys) {
+    values.assign(numKeys, 0);
+    present.assign(numKeys, false);
+    count = 0;
+    mean = 0;
+    m2 = 0;
+    maxValue = 0;
+    maxValid = true;
+    positiveBuckets.clear();
+    negativeBuckets.clear();
+}
+
+int MetricsAccumulator::getBucket(double value) {
+    if (fabs(value) < SKETCH_MIN_VALUE)
+        return 0;
+    int bucket = 1 + (int)ceil(log(fabs(value) / SKETCH_MIN_VALUE) / log(SKETCH_GAMMA));
+    return value > 0 ? bucket : -bucket;
+}
+
+double MetricsAccumulator::getBucketValue(int bucket) {
+    if (bucket == 0)
+        return 0;
+    // Bucket b covers (gamma^(b-2), gamma^(b-1)] times the minimum value, and this is the point with the same relative
+    // error to both limits
+    double value = SKETCH_MIN_VALUE * pow(SKETCH_GAMMA, abs(bucket) - 1) * 2 / (1 + SKETCH_GAMMA);
+    return bucket > 0 ? value : -value;
+}
+
+size_t &MetricsAccumulator::getBucketCount(int bucket) {
+    vector<size_t> &buckets = bucket >= 0 ? positiveBuckets : negativeBuckets;
+    size_t index = (size_t)abs(bucket);
+    if (index >= buckets.size())
+        buckets.resize(index + 1, 0);
+    return buckets[index];
+}
+
+void MetricsAccumulator::add(double value) {
+    count++;
+    double delta = value - mean;
+    mean += delta / (double)count;
+    m2 += delta * (value - mean);
+
+    if (maxValid && (count == 1 || value > maxValue))
+        maxValue = value;
+    getBucketCount(getBucket(value))++;
+}
+
+void MetricsAccumulator::remove(double value) {
+    if (count == 1) {
+        count = 0;
+        mean = 0;
+        m2 = 0;
+    } else {
+        double delta = value - mean;
+        count--;
+        mean -= delta / (double)count;
+        m2 = max(0.0, m2 - delta * (value - mean));
+    }
+
+    if (value >= maxValue)
+        maxValid = false;
+    getBucketCount(getBucket(value))--;
+}
+
+void MetricsAccumulator::set(int key, double value) {
+    if (present[key])
+        remove(values[key]);
+    values[key] = value;
+    present[key] = true;
+    add(value);
+}
+
+void MetricsAccumulator::erase(int key) {
+    if (!present[key])
+        return;
+    remove(values[key]);
+    present[key] = false;
+}
+
+size_t MetricsAccumulator::getCount() const {
+    return count;
+}
+
+double MetricsAccumulator::getMax() const {
+    if (!maxValid) {
+        maxValue = 0;
+        bool first = true;
+        for (size_t key = 0; key < values.size(); key++) {
+            if (present[key] && (first || values[key] > maxValue)) {
+                maxValue = values[key];
+                first = false;
+            }
+        }
+        maxValid = true;
+    }
+    return maxValue;
+}
+
+double MetricsAccumulator::getMean() const {
+    return mean;
+}
+
+double MetricsAccumulator::getVariance() const {
+    return count == 0 ? 0 : m2 / (double)count;
+}
+
+double MetricsAccumulator::getQuantile(double q) const {
+    if (count == 0)
+        return 0;
+    if (q >= 1)
+        return getMax();
+    size_t rank = (size_t)(min(max(q, 0.0), 1.0) * (double)(count - 1)), seen = 0;
+
+    // The buckets are visited from the most negative to the most positive
+    for (size_t index = negativeBuckets.size(); index-- > 1;) {
+        seen += negativeBuckets[index];
+        if (seen > rank)
+            return getBucketValue(-(int)index);
+    }
+    for (size_t index = 0; index < positiveBuckets.size(); index++) {
+        seen += positiveBuckets[index];
+        if (seen > rank)
+            return getBucketValue((int)index);
+    }
+    return getMax();
+}
+
+tuple<double, double, double> MetricsAccumulator::getMetrics() const {
+    return make_tuple(getMax(), getMean(), getVariance());
+}
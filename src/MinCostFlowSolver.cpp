@@ -0,0 +1,111 @@
+#include "MinCostFlowSolver.h"
+
+#include <queue>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Residual capacities and reduced costs smaller than this are considered zero
+ */
+static const double COST_EPSILON = 1e-9;
+
+MinCostFlowSolver::MinCostFlowSolver(const FlowGraph &graph, const vector<double> &costs)
+        : graph(graph), costs(costs), sent(graph.getNumArcs(), 0), flows(graph.getNumArcs(), 0),
+          potentials(graph.getNumVertices(), 0) {
+    this->costs.resize(graph.getNumArcs(), 0);
+}
+
+double MinCostFlowSolver::getResidual(int residual) const {
+    int arc = residual >> 1;
+    return (residual & 1) == 0 ? graph.getCapacity(arc) - sent[arc] : sent[arc];
+}
+
+bool MinCostFlowSolver::findShortestPath() {
+    int numVertices = graph.getNumVertices();
+    double infinity = numeric_limits<double>::infinity();
+    distances.assign(numVertices, infinity);
+    parentResiduals.assign(numVertices, -1);
+
+    typedef pair<double, int> Entry;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> queue;
+    distances[graph.getSource()] = 0;
+    queue.push(Entry(0, graph.getSource()));
+
+    auto relax = [&](int v, int residual, int w, double cost) {
+        if (getResidual(residual) <= COST_EPSILON)
+            return;
+        // The reduced costs are never negative, except for rounding errors
+        double reduced = max(0.0, cost + potentials[v] - potentials[w]);
+        if (distances[v] + reduced < distances[w] - COST_EPSILON) {
+            distances[w] = distances[v] + reduced;
+            parentResiduals[w] = residual;
+            queue.push(Entry(distances[w], w));
+        }
+    };
+
+    while (!queue.empty()) {
+        Entry entry = queue.top();
+        queue.pop();
+        int v = entry.second;
+        if (entry.first > distances[v])
+            continue;
+        for (int pos = graph.getOutBegin(v); pos < graph.getOutEnd(v); pos++) {
+            int arc = graph.getOutArc(pos);
+            relax(v, arc << 1, graph.getHead(arc), costs[arc]);
+        }
+        for (int pos = graph.getInBegin(v); pos < graph.getInEnd(v); pos++) {
+            int arc = graph.getInArc(pos);
+            relax(v, (arc << 1) | 1, graph.getTail(arc), -costs[arc]);
+        }
+    }
+
+    // Unreachable vertices get the largest distance, which keeps the reduced costs of their residual arcs non-negative
+    double farthest = 0;
+    for (double distance: distances) {
+        if (distance != infinity)
+            farthest = max(farthest, distance);
+    }
+    for (int v = 0; v < numVertices; v++)
+        potentials[v] += distances[v] == infinity ? farthest : distances[v];
+
+    return distances[graph.getSink()] != infinity;
+}
+
+double MinCostFlowSolver::solve() {
+    double maxFlow = 0;
+    while (findShortestPath()) {
+        double bottleneck = numeric_limits<double>::infinity();
+        for (int v = graph.getSink(); v != graph.getSource();) {
+            int residual = parentResiduals[v], arc = residual >> 1;
+            bottleneck = min(bottleneck, getResidual(residual));
+            v = (residual & 1) == 0 ? graph.getTail(arc) : graph.getHead(arc);
+        }
+        for (int v = graph.getSink(); v != graph.getSource();) {
+            int residual = parentResiduals[v], arc = residual >> 1;
+            sent[arc] += (residual & 1) == 0 ? bottleneck : -bottleneck;
+            v = (residual & 1) == 0 ? graph.getTail(arc) : graph.getHead(arc);
+        }
+        maxFlow += bottleneck;
+    }
+
+    for (int arc = 0; arc < graph.getNumArcs(); arc++) {
+        int reverse = graph.getReverse(arc);
+        flows[arc] = reverse == -1 ? sent[arc] : sent[arc] - sent[reverse];
+    }
+    return maxFlow;
+}
+
+const vector<double> &MinCostFlowSolver::getFlows() const {
+    return flows;
+}
+
+double MinCostFlowSolver::getCost() const {
+    double cost = 0;
+    for (int arc = 0; arc < graph.getNumArcs(); arc++) {
+        if (flows[arc] > 0)
+            cost += flows[arc] * costs[arc];
+    }
+    return cost;
+}
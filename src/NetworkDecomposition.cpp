@@ -0,0 +1,263 @@
+#include "NetworkDecomposition.h"
+#include "FlowGraphReducer.h"
+#include "PushRelabelSolver.h"
+#include "TaskScheduler.h"
+
+#include <algorithm>
+
+using namespace std;
+
+NetworkDecomposition::NetworkDecomposition() = default;
+
+void NetworkDecomposition::build(const FlowGraph &graph) {
+    int numVertices = graph.getNumVertices(), numArcs = graph.getNumArcs();
+    int source = graph.getSource(), sink = graph.getSink();
+
+    vertexComponents.assign(numVertices, -1);
+    componentVertices.clear();
+    vector<int> queue;
+    for (int root = 0; root < numVertices; root++) {
+        if (root == source || root == sink || vertexComponents[root] != -1)
+            continue;
+        int component = (int)componentVertices.size();
+        queue.assign(1, root);
+        vertexComponents[root] = component;
+        for (size_t head = 0; head < queue.size(); head++) {
+            int u = queue[head];
+            auto visit = [&](int w) {
+                if (w == source || w == sink || vertexComponents[w] != -1)
+                    return;
+                vertexComponents[w] = component;
+                queue.push_back(w);
+            };
+            for (int pos = graph.getOutBegin(u); pos < graph.getOutEnd(u); pos++)
+                visit(graph.getHead(graph.getOutArc(pos)));
+            for (int pos = graph.getInBegin(u); pos < graph.getInEnd(u); pos++)
+                visit(graph.getTail(graph.getInArc(pos)));
+        }
+        sort(queue.begin(), queue.end());
+        componentVertices.push_back(queue);
+    }
+
+    arcComponents.assign(numArcs, -1);
+    componentArcs.assign(componentVertices.size(), vector<int>());
+    for (int arc = 0; arc < numArcs; arc++) {
+        int tail = graph.getTail(arc), head = graph.getHead(arc);
+        arcComponents[arc] = vertexComponents[tail] != -1 ? vertexComponents[tail] : vertexComponents[head];
+        if (arcComponents[arc] != -1)
+            componentArcs[arcComponents[arc]].push_back(arc);
+    }
+
+    findArticulations(graph);
+}
+
+void NetworkDecomposition::findArticulations(const FlowGraph &graph) {
+    int numVertices = graph.getNumVertices(), source = graph.getSource(), sink = graph.getSink();
+    articulationPoints.assign(numVertices, false);
+    bridges.assign(graph.getNumArcs(), false);
+    bridgeChildren.assign(graph.getNumArcs(), -1);
+    componentSources.assign(componentVertices.size(), 0);
+
+    // A bidirectional pipe is a single edge, identified by the smallest of its two arcs
+    auto edgeOf = [&](int arc) {
+        int reverse = graph.getReverse(arc);
+        return reverse != -1 && reverse < arc ? reverse : arc;
+    };
+    // The neighbours of a vertex are its outgoing arcs followed by its incoming arcs
+    auto degreeOf = [&](int v) {
+        return graph.getOutEnd(v) - graph.getOutBegin(v) + graph.getInEnd(v) - graph.getInBegin(v);
+    };
+    auto arcAt = [&](int v, int i) {
+        int outDegree = graph.getOutEnd(v) - graph.getOutBegin(v);
+        return i < outDegree ? graph.getOutArc(graph.getOutBegin(v) + i) : graph.getInArc(graph.getInBegin(v) + i - outDegree);
+    };
+
+    // The subtrees of the search count their vertices and the ones fed by the source, to tell the sides of the bridges
+    discovery.assign(numVertices, -1);
+    subtreeSizes.assign(numVertices, 1);
+    subtreeSources.assign(numVertices, 0);
+    for (int pos = graph.getOutBegin(source); pos < graph.getOutEnd(source); pos++) {
+        int v = graph.getHead(graph.getOutArc(pos));
+        if (v != sink && v != source && subtreeSources[v] == 0) {
+            subtreeSources[v] = 1;
+            componentSources[vertexComponents[v]]++;
+        }
+    }
+    vector<int> low(numVertices, 0), parentEdge(numVertices, -1), next(numVertices, 0);
+    vector<int> stack;
+    int time = 0;
+    for (int root = 0; root < numVertices; root++) {
+        if (root == source || root == sink || discovery[root] != -1)
+            continue;
+        int rootChildren = 0;
+        discovery[root] = low[root] = time++;
+        stack.assign(1, root);
+        while (!stack.empty()) {
+            int u = stack.back();
+            if (next[u] < degreeOf(u)) {
+                int arc = arcAt(u, next[u]++), edge = edgeOf(arc);
+                int w = graph.getTail(arc) == u ? graph.getHead(arc) : graph.getTail(arc);
+                if (w == source || w == sink || w == u || edge == parentEdge[u])
+                    continue;
+                if (discovery[w] == -1) {
+                    discovery[w] = low[w] = time++;
+                    parentEdge[w] = edge;
+                    stack.push_back(w);
+                    rootChildren += u == root;
+                }
+                else {
+                    low[u] = min(low[u], discovery[w]);
+                }
+                continue;
+            }
+
+            stack.pop_back();
+            if (stack.empty())
+                break;
+            int parent = stack.back();
+            low[parent] = min(low[parent], low[u]);
+            subtreeSizes[parent] += subtreeSizes[u];
+            subtreeSources[parent] += subtreeSources[u];
+            if (low[u] > discovery[parent]) {
+                bridges[parentEdge[u]] = true;
+                bridgeChildren[parentEdge[u]] = u;
+                if (graph.getReverse(parentEdge[u]) != -1) {
+                    bridges[graph.getReverse(parentEdge[u])] = true;
+                    bridgeChildren[graph.getReverse(parentEdge[u])] = u;
+                }
+            }
+            if (parent != root && low[u] >= discovery[parent])
+                articulationPoints[parent] = true;
+        }
+        articulationPoints[root] = rootChildren > 1;
+    }
+}
+
+int NetworkDecomposition::getNumComponents() const {
+    return (int)componentVertices.size();
+}
+
+int NetworkDecomposition::getComponent(int v) const {
+    return vertexComponents[v];
+}
+
+int NetworkDecomposition::getArcComponent(int arc) const {
+    return arcComponents[arc];
+}
+
+const vector<int> &NetworkDecomposition::getComponentVertices(int component) const {
+    return componentVertices[component];
+}
+
+const vector<int> &NetworkDecomposition::getComponentArcs(int component) const {
+    return componentArcs[component];
+}
+
+bool NetworkDecomposition::isArticulationPoint(int v) const {
+    return articulationPoints[v];
+}
+
+bool NetworkDecomposition::isBridge(int arc) const {
+    return bridges[arc];
+}
+
+bool NetworkDecomposition::separatesFromSource(int arc, int v) const {
+    int child = bridgeChildren[arc];
+    if (child == -1 || vertexComponents[v] != vertexComponents[child])
+        return false;
+    // The side of the child is its subtree, whose vertices were discovered right after it
+    bool inSubtree = discovery[v] >= discovery[child] && discovery[v] < discovery[child] + subtreeSizes[child];
+    int sources = inSubtree ? subtreeSources[child] : componentSources[vertexComponents[child]] - subtreeSources[child];
+    return sources == 0;
+}
+
+double NetworkDecomposition::getComponentFlow(const FlowGraph &graph, const vector<double> &flows,
+                                              int component) const {
+    double flow = 0;
+    for (int arc: componentArcs[component]) {
+        if (graph.getHead(arc) == graph.getSink())
+            flow += flows[arc];
+        else if (graph.getTail(arc) == graph.getSink())
+            flow -= flows[arc];
+    }
+    return flow;
+}
+
+double NetworkDecomposition::solveComponent(const FlowGraph &graph, int component, vector<double> &flows,
+                                            const vector<char> &blocked, unsigned numThreads) const {
+    const vector<int> &vertices = componentVertices[component], &arcs = componentArcs[component];
+    int numLocal = (int)vertices.size(), localSource = numLocal, localSink = numLocal + 1;
+    auto localVertex = [&](int v) {
+        if (v == graph.getSource())
+            return localSource;
+        if (v == graph.getSink())
+            return localSink;
+        return (int)(lower_bound(vertices.begin(), vertices.end(), v) - vertices.begin());
+    };
+
+    vector<int> tails(arcs.size()), heads(arcs.size()), reverses(arcs.size(), -1);
+    vector<double> capacities(arcs.size());
+    vector<char> localBlocked(arcs.size());
+    for (size_t i = 0; i < arcs.size(); i++) {
+        int arc = arcs[i], reverse = graph.getReverse(arc);
+        tails[i] = localVertex(graph.getTail(arc));
+        heads[i] = localVertex(graph.getHead(arc));
+        if (reverse != -1)
+            reverses[i] = (int)(lower_bound(arcs.begin(), arcs.end(), reverse) - arcs.begin());
+        capacities[i] = graph.getCapacity(arc);
+        localBlocked[i] = blocked[arc];
+    }
+    FlowGraph local;
+    local.build(numLocal + 2, localSource, localSink, tails, heads, reverses, capacities);
+
+    FlowGraphReducer reducer(local);
+    reducer.reduce(localBlocked);
+    vector<double> reducedFlows(reducer.getReducedGraph().getNumArcs(), 0), localFlows;
+    PushRelabelSolver solver(reducer.getReducedGraph(), numThreads);
+    solver.solve(reducedFlows, reducer.getReducedBlocked());
+    reducer.expandFlows(reducedFlows, localFlows);
+
+    for (size_t i = 0; i < arcs.size(); i++)
+        flows[arcs[i]] = localFlows[i];
+    return local.getInflow(localFlows, localSink);
+}
+
+double NetworkDecomposition::solveComponents(const FlowGraph &graph, const vector<int> &components,
+                                             vector<double> &flows, const vector<char> &blocked,
+                                             unsigned numThreads) const {
+    if (components.size() == 1)
+        return solveComponent(graph, components[0], flows, blocked, numThreads);
+
+    // The components have disjoint arcs, so their solvers write to different flows
+    vector<double> componentFlows(components.size(), 0);
+    TaskScheduler scheduler(numThreads);
+    scheduler.run(components.size(), [&](size_t i, unsigned) {
+        componentFlows[i] = solveComponent(graph, components[i], flows, blocked, 1);
+    });
+
+    double flow = 0;
+    for (double componentFlow: componentFlows)
+        flow += componentFlow;
+    return flow;
+}
+
+double NetworkDecomposition::solve(const FlowGraph &graph, vector<double> &flows, const vector<char> &blocked,
+                                   unsigned numThreads) const {
+    flows.assign(graph.getNumArcs(), 0);
+    // Arcs straight from the source to the sink are not in any component, and are always saturated
+    double flow = 0;
+    for (int arc = 0; arc < graph.getNumArcs(); arc++) {
+        if (arcComponents[arc] != -1 || blocked[arc] || graph.getTail(arc) != graph.getSource()
+            || graph.getHead(arc) != graph.getSink())
+            continue;
+        flows[arc] = graph.getCapacity(arc);
+        if (graph.getReverse(arc) != -1)
+            flows[graph.getReverse(arc)] = -graph.getCapacity(arc);
+        flow += graph.getCapacity(arc);
+    }
+
+    vector<int> components((size_t)getNumComponents());
+    for (int c = 0; c < getNumComponents(); c++)
+        components[c] = c;
+    return flow + (components.empty() ? 0 : solveComponents(graph, components, flows, blocked, numThreads));
+}
@@ -0,0 +1,197 @@
+#include "ParallelBfs.h"
+
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Number of vertices (of the frontier or of the graph) expanded by each chunk of a level
+ */
+static const size_t CHUNK_SIZE = 1024;
+
+/**
+ * @brief Smallest number of arcs scanned by a level for it to be expanded in several threads
+ */
+static const long MIN_PARALLEL_WORK = 1 << 15;
+
+/**
+ * @brief A level is expanded bottom-up when the frontier has more than 1/ALPHA of the arcs not yet explored
+ */
+static const long ALPHA = 14;
+
+/**
+ * @brief Levels go back to top-down when the frontier has less than 1/BETA of the vertices
+ */
+static const long BETA = 24;
+
+ParallelBfs::ParallelBfs(const FlowGraph &graph, unsigned numThreads) : graph(graph), numThreads(1), visitStamp(0) {
+    setNumThreads(numThreads);
+}
+
+void ParallelBfs::setNumThreads(unsigned numThreads) {
+    this->numThreads = numThreads == 0 ? max(1u, thread::hardware_concurrency()) : numThreads;
+    if (scheduler != nullptr && scheduler->getNumWorkers() != this->numThreads)
+        scheduler.reset();
+}
+
+void ParallelBfs::setScheduler(const shared_ptr<TaskScheduler> &scheduler) {
+    this->scheduler = scheduler;
+}
+
+bool ParallelBfs::isWorthIt() const {
+    return numThreads > 1 && graph.getNumVertices() >= MIN_VERTICES;
+}
+
+int ParallelBfs::getDegree(int v) const {
+    return graph.getOutEnd(v) - graph.getOutBegin(v) + graph.getInEnd(v) - graph.getInBegin(v);
+}
+
+template<class F>
+void ParallelBfs::runChunks(size_t numChunks, long work, const F &chunk) {
+    if (numThreads <= 1 || numChunks <= 1 || work < MIN_PARALLEL_WORK) {
+        for (size_t c = 0; c < numChunks; c++)
+            chunk(c);
+        return;
+    }
+    if (scheduler == nullptr)
+        scheduler = make_shared<TaskScheduler>(numThreads);
+    scheduler->run(numChunks, [&](size_t c, unsigned) {
+        chunk(c);
+    });
+}
+
+bool ParallelBfs::search(const vector<double> &flows, const vector<double> &capacities, const vector<char> &blocked,
+                         vector<int> &parentArc, vector<char> &parentDirect) {
+    return expand(graph.getSource(), graph.getSink(), false, 0, flows, capacities, blocked, &parentArc, &parentDirect);
+}
+
+void ParallelBfs::searchToSink(const vector<double> &flows, const vector<double> &capacities,
+                               const vector<char> &blocked, double epsilon) {
+    expand(graph.getSink(), -1, true, epsilon, flows, capacities, blocked, nullptr, nullptr);
+}
+
+bool ParallelBfs::expand(int start, int stop, bool backward, double epsilon, const vector<double> &flows,
+                         const vector<double> &capacities, const vector<char> &blocked, vector<int> *parentArc,
+                         vector<char> *parentDirect) {
+    int numVertices = graph.getNumVertices();
+    visited.resize(numVertices, 0);
+    inFrontier.resize(numVertices, 0);
+    if (++visitStamp == 0) {
+        visited.assign(visited.size(), 0);
+        visitStamp = 1;
+    }
+    unsigned stamp = visitStamp;
+
+    // Whether an arc can be followed from its tail to its head, and the other way. Searching forwards, the vertex found
+    // next must be able to receive water through the arc, and searching backwards, to send it
+    auto headUsable = [&](int arc) {
+        return backward ? flows[arc] > epsilon : capacities[arc] - flows[arc] > epsilon;
+    };
+    auto tailUsable = [&](int arc) {
+        return backward ? capacities[arc] - flows[arc] > epsilon : flows[arc] > epsilon;
+    };
+
+    frontier.assign(1, start);
+    visited[start] = stamp;
+    long unexplored = 2 * (long)graph.getNumArcs() - getDegree(start);
+    bool bottomUp = false;
+    vector<int> next;
+
+    while (!frontier.empty() && (stop == -1 || visited[stop] != stamp)) {
+        long frontierWork = 0;
+        for (int u: frontier)
+            frontierWork += getDegree(u);
+        if (!bottomUp)
+            bottomUp = frontierWork > unexplored / ALPHA;
+        else
+            bottomUp = (long)frontier.size() >= numVertices / BETA;
+
+        next.clear();
+        if (bottomUp) {
+            for (int u: frontier)
+                inFrontier[u] = 1;
+            size_t numChunks = (numVertices + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            chunkVertices.resize(numChunks);
+            // Each chunk only writes the state of its own vertices
+            runChunks(numChunks, unexplored, [&](size_t c) {
+                vector<int> &found = chunkVertices[c];
+                found.clear();
+                int end = (int)min((c + 1) * CHUNK_SIZE, (size_t)numVertices);
+                for (int v = (int)(c * CHUNK_SIZE); v < end; v++) {
+                    if (visited[v] == stamp)
+                        continue;
+                    int arc = -1;
+                    bool direct = true;
+                    for (int pos = graph.getInBegin(v); pos < graph.getInEnd(v) && arc == -1; pos++) {
+                        int a = graph.getInArc(pos);
+                        if (inFrontier[graph.getTail(a)] && !blocked[a] && headUsable(a))
+                            arc = a;
+                    }
+                    for (int pos = graph.getOutBegin(v); pos < graph.getOutEnd(v) && arc == -1; pos++) {
+                        int a = graph.getOutArc(pos);
+                        if (inFrontier[graph.getHead(a)] && !blocked[a] && tailUsable(a)) {
+                            arc = a;
+                            direct = false;
+                        }
+                    }
+                    if (arc == -1)
+                        continue;
+                    visited[v] = stamp;
+                    if (parentArc != nullptr) {
+                        (*parentArc)[v] = arc;
+                        (*parentDirect)[v] = direct;
+                    }
+                    found.push_back(v);
+                }
+            });
+            for (int u: frontier)
+                inFrontier[u] = 0;
+            for (size_t c = 0; c < numChunks; c++)
+                next.insert(next.end(), chunkVertices[c].begin(), chunkVertices[c].end());
+        } else {
+            size_t numChunks = (frontier.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            chunkCandidates.resize(numChunks);
+            // The chunks only read the visited vertices, which are updated afterwards in the order of the frontier
+            runChunks(numChunks, frontierWork, [&](size_t c) {
+                vector<Candidate> &candidates = chunkCandidates[c];
+                candidates.clear();
+                size_t end = min((c + 1) * CHUNK_SIZE, frontier.size());
+                for (size_t i = c * CHUNK_SIZE; i < end; i++) {
+                    int u = frontier[i];
+                    for (int pos = graph.getOutBegin(u); pos < graph.getOutEnd(u); pos++) {
+                        int arc = graph.getOutArc(pos), v = graph.getHead(arc);
+                        if (!blocked[arc] && visited[v] != stamp && headUsable(arc))
+                            candidates.push_back(Candidate{v, arc, true});
+                    }
+                    for (int pos = graph.getInBegin(u); pos < graph.getInEnd(u); pos++) {
+                        int arc = graph.getInArc(pos), v = graph.getTail(arc);
+                        if (!blocked[arc] && visited[v] != stamp && tailUsable(arc))
+                            candidates.push_back(Candidate{v, arc, false});
+                    }
+                }
+            });
+            for (size_t c = 0; c < numChunks; c++) {
+                for (const Candidate &candidate: chunkCandidates[c]) {
+                    if (visited[candidate.vertex] == stamp)
+                        continue;
+                    visited[candidate.vertex] = stamp;
+                    if (parentArc != nullptr) {
+                        (*parentArc)[candidate.vertex] = candidate.arc;
+                        (*parentDirect)[candidate.vertex] = candidate.direct;
+                    }
+                    next.push_back(candidate.vertex);
+                }
+            }
+        }
+
+        for (int v: next)
+            unexplored -= getDegree(v);
+        frontier.swap(next);
+    }
+    return stop != -1 && visited[stop] == stamp;
+}
+
+bool ParallelBfs::isReached(int v) const {
+    return v < (int)visited.size() && visited[v] == visitStamp;
+}
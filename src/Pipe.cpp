@@ -1,6 +1,6 @@
 #include "Pipe.h"
 
-Pipe::Pipe(Vertex<std::string> *orig, Vertex<std::string> *dest, double capacity) : Edge(orig, dest, capacity), hidden(false) {}
+Pipe::Pipe(Vertex<std::string> *orig, Vertex<std::string> *dest, double capacity) : Edge(orig, dest, capacity), index(-1), hidden(false), cost(0), twin(nullptr) {}
 
 double Pipe::getCapacity() const {
     return getWeight();
@@ -18,16 +18,44 @@ Pipe *Pipe::getReverse() const {
     return dynamic_cast<Pipe*>(Edge::getReverse());
 }
 
+Pipe *Pipe::getTwin() const {
+    return twin;
+}
+
+void Pipe::setTwin(Pipe *twin) {
+    this->twin = twin;
+}
+
+bool Pipe::isBidirectional() const {
+    return getReverse() != nullptr || twin != nullptr;
+}
+
 double Pipe::getRemainingFlow() const {
     return getWeight() - getFlow();
 }
 
-const std::vector<AugmentingPath*> &Pipe::getAugmentingPaths() const {
-    return augmentingPaths;
+void Pipe::updateFlow(double flow) {
+    double delta = flow - getFlow();
+    // Every vertex of a water supply network is a service point
+    static_cast<ServicePoint*>(Edge::getOrig())->addFlow(0, delta);
+    static_cast<ServicePoint*>(Edge::getDest())->addFlow(delta, 0);
+    Edge::setFlow(flow);
+}
+
+double Pipe::getCost() const {
+    return cost;
+}
+
+void Pipe::setCost(double cost) {
+    this->cost = cost;
 }
 
-std::vector<AugmentingPath*> &Pipe::getAugmentingPaths() {
-    return augmentingPaths;
+int Pipe::getIndex() const {
+    return index;
+}
+
+void Pipe::setIndex(int index) {
+    this->index = index;
 }
 
 bool Pipe::operator==(const Pipe &pipe) const {
@@ -46,9 +74,4 @@ void Pipe::setCapacity(double capacity) {
     setWeight(capacity);
 }
 
-void Pipe::selectAugmentingPaths() const {
-    for (AugmentingPath* path : augmentingPaths)
-        path->setSelected(true);
-}
-
 
@@ -1,7 +1,34 @@
 #include "PumpingStation.h"
 
-PumpingStation::PumpingStation(int id, const std::string &code) : ServicePoint(id, code) {}
+#include <limits>
+
+PumpingStation::PumpingStation(int id, const std::string &code)
+        : ServicePoint(id, code), pumpingCost(0), capacity(std::numeric_limits<double>::infinity()), outlet(nullptr) {}
 
 std::string PumpingStation::getDescription() const {
     return getCode();
-}
\ No newline at end of file
+}
+
+double PumpingStation::getPumpingCost() const {
+    return pumpingCost;
+}
+
+void PumpingStation::setPumpingCost(double pumpingCost) {
+    this->pumpingCost = pumpingCost;
+}
+
+double PumpingStation::getCapacity() const {
+    return capacity;
+}
+
+void PumpingStation::setCapacity(double capacity) {
+    this->capacity = capacity;
+}
+
+ServicePoint *PumpingStation::getOutlet() const {
+    return outlet;
+}
+
+void PumpingStation::setOutlet(ServicePoint *outlet) {
+    this->outlet = outlet;
+}
@@ -0,0 +1,215 @@
+#include "PushRelabelSolver.h"
+
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Number of active vertices discharged by each task of a round
+ */
+static const size_t CHUNK_SIZE = 256;
+
+/**
+ * @brief Smallest number of active vertices for a round to be run in several threads
+ */
+static const size_t MIN_PARALLEL_VERTICES = 4096;
+
+PushRelabelSolver::PushRelabelSolver(const FlowGraph &graph, unsigned numThreads)
+        : graph(graph), flows(nullptr), blocked(nullptr), scheduler(numThreads), incoming(graph.getNumVertices()),
+          workerReceivers(scheduler.getNumWorkers()) {
+    for (atomic<double> &excess: incoming)
+        excess.store(0, memory_order_relaxed);
+}
+
+void PushRelabelSolver::pushFlow(int arc, bool direct, double value) {
+    vector<double> &flows = *this->flows;
+    flows[arc] += direct ? value : -value;
+    int reverse = graph.getReverse(arc);
+    if (reverse != -1)
+        flows[reverse] -= direct ? value : -value;
+}
+
+void PushRelabelSolver::discharge(int v, unsigned worker) {
+    const vector<double> &flows = *this->flows;
+    const vector<char> &blocked = *this->blocked;
+    double excess = excesses[v];
+    int target = labels[v] - 1;
+
+    // The labels are checked first: the arcs to neighbours with the target label are not touched by other threads
+    for (int pos = graph.getOutBegin(v); pos < graph.getOutEnd(v) && excess > 0; pos++) {
+        int arc = graph.getOutArc(pos), w = graph.getHead(arc);
+        if (labels[w] != target || blocked[arc] || graph.getCapacity(arc) - flows[arc] <= 0)
+            continue;
+        double value = min(excess, graph.getCapacity(arc) - flows[arc]);
+        pushFlow(arc, true, value);
+        excess -= value;
+        double current = incoming[w].load(memory_order_relaxed);
+        while (!incoming[w].compare_exchange_weak(current, current + value, memory_order_relaxed));
+        workerReceivers[worker].push_back(w);
+    }
+    for (int pos = graph.getInBegin(v); pos < graph.getInEnd(v) && excess > 0; pos++) {
+        int arc = graph.getInArc(pos), w = graph.getTail(arc);
+        if (labels[w] != target || blocked[arc] || flows[arc] <= 0)
+            continue;
+        double value = min(excess, flows[arc]);
+        pushFlow(arc, false, value);
+        excess -= value;
+        double current = incoming[w].load(memory_order_relaxed);
+        while (!incoming[w].compare_exchange_weak(current, current + value, memory_order_relaxed));
+        workerReceivers[worker].push_back(w);
+    }
+    excesses[v] = excess;
+}
+
+int PushRelabelSolver::calculateLabel(int v) const {
+    const vector<double> &flows = *this->flows;
+    const vector<char> &blocked = *this->blocked;
+    int label = 2 * graph.getNumVertices() - 1;
+    for (int pos = graph.getOutBegin(v); pos < graph.getOutEnd(v); pos++) {
+        int arc = graph.getOutArc(pos);
+        if (!blocked[arc] && graph.getCapacity(arc) - flows[arc] > 0)
+            label = min(label, labels[graph.getHead(arc)]);
+    }
+    for (int pos = graph.getInBegin(v); pos < graph.getInEnd(v); pos++) {
+        int arc = graph.getInArc(pos);
+        if (!blocked[arc] && flows[arc] > 0)
+            label = min(label, labels[graph.getTail(arc)]);
+    }
+    return label + 1;
+}
+
+void PushRelabelSolver::labelBackwards(int root) {
+    const vector<double> &flows = *this->flows;
+    const vector<char> &blocked = *this->blocked;
+    int unlabeled = 2 * graph.getNumVertices();
+    queue.clear();
+    queue.push_back(root);
+    for (size_t head = 0; head < queue.size(); head++) {
+        int u = queue[head];
+        // Vertices that can push to u: tails of its incoming arcs with residual capacity, heads of its outgoing arcs
+        // with flow
+        for (int pos = graph.getInBegin(u); pos < graph.getInEnd(u); pos++) {
+            int arc = graph.getInArc(pos), v = graph.getTail(arc);
+            if (labels[v] != unlabeled || blocked[arc] || graph.getCapacity(arc) - flows[arc] <= 0)
+                continue;
+            labels[v] = labels[u] + 1;
+            queue.push_back(v);
+        }
+        for (int pos = graph.getOutBegin(u); pos < graph.getOutEnd(u); pos++) {
+            int arc = graph.getOutArc(pos), v = graph.getHead(arc);
+            if (labels[v] != unlabeled || blocked[arc] || flows[arc] <= 0)
+                continue;
+            labels[v] = labels[u] + 1;
+            queue.push_back(v);
+        }
+    }
+}
+
+void PushRelabelSolver::globalRelabel() {
+    int numVertices = graph.getNumVertices();
+    labels.assign(numVertices, 2 * numVertices);
+    labels[graph.getSink()] = 0;
+    labels[graph.getSource()] = numVertices;
+    labelBackwards(graph.getSink());
+    labelBackwards(graph.getSource());
+}
+
+template<class F>
+void PushRelabelSolver::forEachActive(const F &function) {
+    if (scheduler.getNumWorkers() <= 1 || active.size() < MIN_PARALLEL_VERTICES) {
+        for (int v: active)
+            function(v, 0);
+        return;
+    }
+    size_t numChunks = (active.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    scheduler.run(numChunks, [&](size_t c, unsigned worker) {
+        size_t end = min((c + 1) * CHUNK_SIZE, active.size());
+        for (size_t i = c * CHUNK_SIZE; i < end; i++)
+            function(active[i], worker);
+    });
+}
+
+double PushRelabelSolver::solve(vector<double> &flows, const vector<char> &blocked) {
+    int numVertices = graph.getNumVertices(), source = graph.getSource(), sink = graph.getSink();
+    if (source == sink)
+        return 0;
+    this->flows = &flows;
+    this->blocked = &blocked;
+    double initialFlow = graph.getInflow(flows, sink);
+
+    excesses.assign(numVertices, 0);
+    newLabels.assign(numVertices, 0);
+    inActive.assign(numVertices, false);
+    active.clear();
+    for (int pos = graph.getOutBegin(source); pos < graph.getOutEnd(source); pos++) {
+        int arc = graph.getOutArc(pos);
+        double value = graph.getCapacity(arc) - flows[arc];
+        if (blocked[arc] || value <= 0)
+            continue;
+        pushFlow(arc, true, value);
+        excesses[graph.getHead(arc)] += value;
+    }
+    for (int pos = graph.getInBegin(source); pos < graph.getInEnd(source); pos++) {
+        int arc = graph.getInArc(pos);
+        double value = flows[arc];
+        if (blocked[arc] || value <= 0)
+            continue;
+        pushFlow(arc, false, value);
+        excesses[graph.getTail(arc)] += value;
+    }
+
+    globalRelabel();
+    for (int v = 0; v < numVertices; v++) {
+        if (v != source && v != sink && excesses[v] > 0 && labels[v] < 2 * numVertices) {
+            active.push_back(v);
+            inActive[v] = true;
+        }
+    }
+
+    long relabels = 0;
+    vector<int> next;
+    while (!active.empty()) {
+        forEachActive([this](int v, unsigned worker) {
+            discharge(v, worker);
+        });
+        // The vertices that kept excess used all their arcs, and their labels are only read again in the next round
+        forEachActive([this](int v, unsigned) {
+            if (excesses[v] > 0)
+                newLabels[v] = calculateLabel(v);
+        });
+        for (int v: active) {
+            if (excesses[v] > 0) {
+                labels[v] = newLabels[v];
+                relabels++;
+            }
+        }
+        if (relabels >= numVertices) {
+            globalRelabel();
+            relabels = 0;
+        }
+
+        next.clear();
+        for (int v: active) {
+            inActive[v] = false;
+            if (excesses[v] > 0 && labels[v] < 2 * numVertices) {
+                next.push_back(v);
+                inActive[v] = true;
+            }
+        }
+        for (vector<int> &receivers: workerReceivers) {
+            for (int w: receivers) {
+                excesses[w] += incoming[w].exchange(0, memory_order_relaxed);
+                if (w != source && w != sink && !inActive[w] && excesses[w] > 0 && labels[w] < 2 * numVertices) {
+                    next.push_back(w);
+                    inActive[w] = true;
+                }
+            }
+            receivers.clear();
+        }
+        active.swap(next);
+    }
+
+    for (int v: active)
+        inActive[v] = false;
+    return graph.getInflow(flows, sink) - initialFlow;
+}
@@ -0,0 +1,257 @@
+#include "ReportWriter.h"
+
+#include <cstdio>
+#include <cmath>
+
+using namespace std;
+
+/**
+ * @brief Size of the chunks in which the buffer is written to the file
+ */
+static const size_t CHUNK_SIZE = 1 << 16;
+
+ReportValue::ReportValue(double number) : isNumber(true), number(number) {}
+
+ReportValue::ReportValue(const string &text) : isNumber(false), number(0), text(text) {}
+
+ReportValue::ReportValue(const char *text) : isNumber(false), number(0), text(text) {}
+
+ReportWriter::ReportWriter() : format(REPORT_TEXT), inSection(false) {}
+
+ReportWriter::~ReportWriter() {
+    close();
+}
+
+bool ReportWriter::open(const string &path, ReportFormat format) {
+    close();
+    bool first = openedPaths.count(path) == 0;
+    ios::openmode mode = ios::out | (first ? ios::trunc : ios::app);
+    if (format == REPORT_BINARY)
+        mode |= ios::binary;
+    output.open(path, mode);
+    if (!output.is_open())
+        return false;
+
+    openedPaths.insert(path);
+    this->format = format;
+    buffer.reserve(CHUNK_SIZE);
+    if (format == REPORT_BINARY && first)
+        buffer.append("WSNR");
+    return true;
+}
+
+void ReportWriter::close() {
+    if (!output.is_open())
+        return;
+    endSection();
+    flush();
+    output.close();
+}
+
+void ReportWriter::flush() {
+    if (!output.is_open() || buffer.empty())
+        return;
+    output.write(buffer.data(), (streamsize)buffer.size());
+    output.flush();
+    buffer.clear();
+}
+
+bool ReportWriter::isOpen() const {
+    return output.is_open();
+}
+
+ReportFormat ReportWriter::getFormat() const {
+    return format;
+}
+
+void ReportWriter::flushIfFull() {
+    if (buffer.size() >= CHUNK_SIZE) {
+        output.write(buffer.data(), (streamsize)buffer.size());
+        buffer.clear();
+    }
+}
+
+void ReportWriter::beginSection(const string &title, const vector<string> &columns) {
+    endSection();
+    inSection = true;
+    this->title = title;
+    this->columns = columns;
+
+    switch (format) {
+        case REPORT_TEXT:
+            buffer.append("===>  ").append(title).push_back('\n');
+            break;
+        case REPORT_CSV:
+            buffer.append("section");
+            for (const string &column: columns) {
+                buffer.push_back(',');
+                appendCsv(column);
+            }
+            buffer.push_back('\n');
+            break;
+        case REPORT_JSONL:
+            break;
+        case REPORT_BINARY:
+            columnValues.assign(columns.size(), vector<ReportValue>());
+            break;
+    }
+    flushIfFull();
+}
+
+void ReportWriter::writeRow(const vector<ReportValue> &values) {
+    if (!inSection)
+        return;
+
+    switch (format) {
+        case REPORT_TEXT:
+            for (size_t i = 0; i < values.size(); i++) {
+                if (i > 0)
+                    buffer.push_back(',');
+                if (values[i].isNumber)
+                    appendNumber(values[i].number);
+                else
+                    buffer.append(values[i].text);
+            }
+            buffer.push_back('\n');
+            break;
+        case REPORT_CSV:
+            appendCsv(title);
+            for (const ReportValue &value: values) {
+                buffer.push_back(',');
+                if (value.isNumber)
+                    appendNumber(value.number);
+                else
+                    appendCsv(value.text);
+            }
+            buffer.push_back('\n');
+            break;
+        case REPORT_JSONL:
+            buffer.append("{\"section\":");
+            appendJson(title);
+            for (size_t i = 0; i < values.size() && i < columns.size(); i++) {
+                buffer.push_back(',');
+                appendJson(columns[i]);
+                buffer.push_back(':');
+                if (!values[i].isNumber)
+                    appendJson(values[i].text);
+                else if (isfinite(values[i].number))
+                    appendNumber(values[i].number);
+                else
+                    buffer.append("null");
+            }
+            buffer.append("}\n");
+            break;
+        case REPORT_BINARY:
+            for (size_t i = 0; i < columns.size(); i++)
+                columnValues[i].push_back(i < values.size() ? values[i] : ReportValue(""));
+            return;
+    }
+    flushIfFull();
+}
+
+void ReportWriter::endSection() {
+    if (!inSection)
+        return;
+    inSection = false;
+    if (format != REPORT_BINARY)
+        return;
+
+    uint32_t numColumns = (uint32_t)columns.size();
+    uint32_t numRows = columns.empty() ? 0 : (uint32_t)columnValues[0].size();
+    appendBinary(title);
+    appendBytes(&numColumns, sizeof(numColumns));
+    appendBytes(&numRows, sizeof(numRows));
+    for (size_t i = 0; i < columns.size(); i++) {
+        // A column is numeric only if all its values are numbers, otherwise the numbers are stored as texts
+        uint8_t type = 0;
+        for (const ReportValue &value: columnValues[i]) {
+            if (!value.isNumber)
+                type = 1;
+        }
+        appendBinary(columns[i]);
+        appendBytes(&type, sizeof(type));
+        for (const ReportValue &value: columnValues[i]) {
+            if (type == 0) {
+                appendBytes(&value.number, sizeof(value.number));
+            } else if (value.isNumber) {
+                char text[32];
+                snprintf(text, sizeof(text), "%g", value.number);
+                appendBinary(text);
+            } else {
+                appendBinary(value.text);
+            }
+        }
+        flushIfFull();
+    }
+    columnValues.clear();
+}
+
+void ReportWriter::appendNumber(double number) {
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%g", number);
+    buffer.append(text, length);
+}
+
+void ReportWriter::appendCsv(const string &text) {
+    if (text.find_first_of(",\"\n\r") == string::npos) {
+        buffer.append(text);
+        return;
+    }
+    buffer.push_back('"');
+    for (char c: text) {
+        if (c == '"')
+            buffer.push_back('"');
+        buffer.push_back(c);
+    }
+    buffer.push_back('"');
+}
+
+void ReportWriter::appendJson(const string &text) {
+    buffer.push_back('"');
+    for (char c: text) {
+        switch (c) {
+            case '"': buffer.append("\\\""); break;
+            case '\\': buffer.append("\\\\"); break;
+            case '\n': buffer.append("\\n"); break;
+            case '\r': buffer.append("\\r"); break;
+            case '\t': buffer.append("\\t"); break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    buffer.append(escaped);
+                } else {
+                    buffer.push_back(c);
+                }
+        }
+    }
+    buffer.push_back('"');
+}
+
+void ReportWriter::appendBytes(const void *data, size_t size) {
+    buffer.append((const char *)data, size);
+}
+
+void ReportWriter::appendBinary(const string &text) {
+    uint32_t length = (uint32_t)text.size();
+    appendBytes(&length, sizeof(length));
+    buffer.append(text);
+}
+
+string ReportWriter::getExtension(ReportFormat format) {
+    switch (format) {
+        case REPORT_CSV: return ".csv";
+        case REPORT_JSONL: return ".jsonl";
+        case REPORT_BINARY: return ".bin";
+        default: return ".txt";
+    }
+}
+
+string ReportWriter::getFormatName(ReportFormat format) {
+    switch (format) {
+        case REPORT_CSV: return "CSV";
+        case REPORT_JSONL: return "JSON Lines";
+        case REPORT_BINARY: return "Binary";
+        default: return "Text";
+    }
+}
@@ -16,10 +16,7 @@ double Reservoir::getMaxDelivery() const {
 }
 
 double Reservoir::getDelivery() const {
-    double delivery = 0;
-    for (Pipe *pipe: ServicePoint::getAdj())
-        delivery += pipe->getFlow();
-    return delivery;
+    return getOutflow();
 }
 
 std::string Reservoir::getDescription() const {
@@ -0,0 +1,274 @@
+#include "ScenarioResultStore.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * @brief Returns the bits of a double, to be compressed
+ * @param value Value to convert
+ * @return Word with the same bits as the value
+ */
+static uint64_t toBits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Returns the double with some bits, after being decompressed
+ * @param bits Bits of the value
+ * @return Value with the same bits as the word
+ */
+static double fromBits(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template<class T>
+static void writeValue(ofstream &output, const T &value) {
+    output.write((const char *)&value, sizeof(value));
+}
+
+static void writeString(ofstream &output, const string &text) {
+    writeValue(output, (uint32_t)text.size());
+    output.write(text.data(), (streamsize)text.size());
+}
+
+template<class T>
+static bool readValue(ifstream &input, T &value) {
+    return (bool)input.read((char *)&value, sizeof(value));
+}
+
+/**
+ * @brief Returns the number of bytes of a file after the current position
+ * @details Used to reject the counts of a corrupt or truncated file before allocating memory for them.
+ * @param input File being read
+ * @return Number of bytes left to read
+ */
+static uint64_t getRemainingBytes(ifstream &input) {
+    streampos current = input.tellg();
+    input.seekg(0, ios::end);
+    streampos end = input.tellg();
+    input.seekg(current);
+    return current < 0 || end < current ? 0 : (uint64_t)(end - current);
+}
+
+static bool readString(ifstream &input, string &text) {
+    uint32_t length;
+    if (!readValue(input, length) || length > getRemainingBytes(input))
+        return false;
+    text.resize(length);
+    return length == 0 || (bool)input.read(&text[0], length);
+}
+
+ScenarioResultStore::ScenarioResultStore() = default;
+
+void ScenarioResultStore::setCities(const vector<DeliverySite *> &cities) {
+    vector<DeliverySite *> sorted(cities);
+    sort(sorted.begin(), sorted.end(), [](const DeliverySite *a, const DeliverySite *b) {
+        return a->getId() < b->getId();
+    });
+
+    cityIds.clear();
+    cityCodes.clear();
+    for (DeliverySite *city: sorted) {
+        cityIds.push_back(city->getId());
+        cityCodes.push_back(city->getCode());
+    }
+    resetColumns();
+}
+
+void ScenarioResultStore::resetColumns() {
+    idToColumn.assign(cityIds.empty() ? 0 : *max_element(cityIds.begin(), cityIds.end()) + 1, -1);
+    for (size_t column = 0; column < cityIds.size(); column++)
+        idToColumn[cityIds[column]] = (int)column;
+    baseline.assign(cityIds.size(), 0);
+    names.clear();
+    columns.assign(cityIds.size(), vector<double>());
+}
+
+int ScenarioResultStore::getNumCities() const {
+    return (int)cityIds.size();
+}
+
+size_t ScenarioResultStore::getNumScenarios() const {
+    return names.size();
+}
+
+int ScenarioResultStore::getColumn(int cityId) const {
+    if (cityId < 0 || cityId >= (int)idToColumn.size())
+        return -1;
+    return idToColumn[cityId];
+}
+
+int ScenarioResultStore::getCityId(int column) const {
+    return cityIds[column];
+}
+
+const string &ScenarioResultStore::getCityCode(int column) const {
+    return cityCodes[column];
+}
+
+void ScenarioResultStore::setBaseline(const vector<double> &supplies) {
+    baseline = supplies;
+    baseline.resize(cityIds.size(), 0);
+}
+
+const vector<double> &ScenarioResultStore::getBaseline() const {
+    return baseline;
+}
+
+size_t ScenarioResultStore::appendScenario(const string &name, const vector<double> &supplies) {
+    lock_guard<mutex> lock(appendMutex);
+    size_t row = names.size();
+    names.push_back(name);
+    for (size_t column = 0; column < columns.size(); column++)
+        columns[column].push_back(column < supplies.size() ? supplies[column] : 0);
+    return row;
+}
+
+size_t ScenarioResultStore::reserveScenarios(size_t count) {
+    lock_guard<mutex> lock(appendMutex);
+    size_t row = names.size();
+    names.resize(row + count);
+    for (vector<double> &column: columns)
+        column.resize(row + count, 0);
+    return row;
+}
+
+void ScenarioResultStore::setScenario(size_t row, const string &name, const vector<double> &supplies) {
+    names[row] = name;
+    for (size_t column = 0; column < columns.size(); column++)
+        columns[column][row] = column < supplies.size() ? supplies[column] : 0;
+}
+
+const string &ScenarioResultStore::getScenarioName(size_t row) const {
+    return names[row];
+}
+
+double ScenarioResultStore::getSupply(size_t row, int column) const {
+    return columns[column][row];
+}
+
+const vector<double> &ScenarioResultStore::getColumnValues(int column) const {
+    return columns[column];
+}
+
+bool ScenarioResultStore::save(const string &path) const {
+    ofstream output(path, ios::out | ios::trunc | ios::binary);
+    if (!output.is_open())
+        return false;
+
+    output.write("WSNS", 4);
+    writeValue(output, (uint32_t)cityIds.size());
+    writeValue(output, (uint64_t)names.size());
+    for (size_t column = 0; column < cityIds.size(); column++) {
+        writeValue(output, (int32_t)cityIds[column]);
+        writeString(output, cityCodes[column]);
+    }
+    for (double supply: baseline)
+        writeValue(output, supply);
+    for (const string &name: names)
+        writeString(output, name);
+
+    vector<uint32_t> runs;
+    vector<uint64_t> literals;
+    for (size_t column = 0; column < columns.size(); column++) {
+        // runs holds pairs (zeros, literals), with the literal words of all the blocks in order in literals
+        runs.clear();
+        literals.clear();
+        uint64_t base = toBits(baseline[column]);
+        size_t row = 0;
+        while (row < names.size()) {
+            uint32_t zeros = 0, count = 0;
+            while (row < names.size() && (toBits(columns[column][row]) ^ base) == 0) {
+                zeros++;
+                row++;
+            }
+            while (row < names.size() && (toBits(columns[column][row]) ^ base) != 0) {
+                literals.push_back(toBits(columns[column][row]) ^ base);
+                count++;
+                row++;
+            }
+            runs.push_back(zeros);
+            runs.push_back(count);
+        }
+
+        writeValue(output, (uint32_t)(runs.size() / 2));
+        size_t literal = 0;
+        for (size_t block = 0; block < runs.size(); block += 2) {
+            writeValue(output, runs[block]);
+            writeValue(output, runs[block + 1]);
+            // A column that ends with baseline values has an empty last block, with no literal words to write
+            if (runs[block + 1] > 0)
+                output.write((const char *)(literals.data() + literal),
+                             (streamsize)(runs[block + 1] * sizeof(uint64_t)));
+            literal += runs[block + 1];
+        }
+    }
+    return (bool)output;
+}
+
+bool ScenarioResultStore::load(const string &path) {
+    cityIds.clear();
+    cityCodes.clear();
+    resetColumns();
+
+    ifstream input(path, ios::in | ios::binary);
+    char magic[4];
+    uint32_t numCities;
+    uint64_t numScenarios;
+    if (!input.read(magic, 4) || memcmp(magic, "WSNS", 4) != 0 || !readValue(input, numCities)
+        || !readValue(input, numScenarios))
+        return false;
+
+    bool ok = true;
+    for (uint32_t column = 0; column < numCities && ok; column++) {
+        int32_t id;
+        string code;
+        ok = readValue(input, id) && readString(input, code) && id >= 0;
+        cityIds.push_back(id);
+        cityCodes.push_back(code);
+    }
+    if (ok)
+        resetColumns();
+    for (uint32_t column = 0; column < numCities && ok; column++)
+        ok = readValue(input, baseline[column]);
+    // Each name takes at least the 4 bytes of its length, so a larger count means that the file is corrupt
+    ok = ok && numScenarios <= getRemainingBytes(input) / sizeof(uint32_t);
+    names.resize(ok ? numScenarios : 0);
+    for (uint64_t row = 0; row < numScenarios && ok; row++)
+        ok = readString(input, names[row]);
+
+    for (uint32_t column = 0; column < numCities && ok; column++) {
+        uint64_t base = toBits(baseline[column]);
+        uint32_t numBlocks;
+        ok = readValue(input, numBlocks);
+        columns[column].reserve(names.size());
+        for (uint32_t block = 0; block < numBlocks && ok; block++) {
+            uint32_t zeros, count;
+            ok = readValue(input, zeros) && readValue(input, count)
+                 && columns[column].size() + zeros + count <= numScenarios;
+            if (!ok)
+                break;
+            columns[column].insert(columns[column].end(), zeros, baseline[column]);
+            for (uint32_t i = 0; i < count && ok; i++) {
+                uint64_t word;
+                ok = readValue(input, word);
+                columns[column].push_back(fromBits(word ^ base));
+            }
+        }
+        ok = ok && columns[column].size() == numScenarios;
+    }
+
+    if (!ok) {
+        cityIds.clear();
+        cityCodes.clear();
+        resetColumns();
+    }
+    return ok;
+}
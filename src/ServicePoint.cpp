@@ -1,13 +1,22 @@
 #include "ServicePoint.h"
+#include <algorithm>
 
 using namespace std;
 
-ServicePoint::ServicePoint(int id, const std::string &code) : Vertex<std::string>(code), id(id), hidden(false) {}
+ServicePoint::ServicePoint(int id, const std::string &code) : Vertex<std::string>(code), id(id), index(-1), hidden(false), inflow(0), outflow(0) {}
 
 int ServicePoint::getId() const{
     return id;
 }
 
+int ServicePoint::getIndex() const {
+    return index;
+}
+
+void ServicePoint::setIndex(int index) {
+    this->index = index;
+}
+
 std::string ServicePoint::getCode() const{
     return this->getInfo();
 }
@@ -32,6 +41,19 @@ std::vector<Pipe *> ServicePoint::getIncoming() const {
     return incoming;
 }
 
+double ServicePoint::getInflow() const {
+    return inflow;
+}
+
+double ServicePoint::getOutflow() const {
+    return outflow;
+}
+
+void ServicePoint::addFlow(double inflowDelta, double outflowDelta) {
+    inflow += inflowDelta;
+    outflow += outflowDelta;
+}
+
 Pipe *ServicePoint::getPath() const {
     return dynamic_cast<Pipe*>(Vertex::getPath());
 }
@@ -46,6 +68,18 @@ Edge<string> *ServicePoint::addEdge(Vertex<string> *dest, double w) {
     return newEdge;
 }
 
+void ServicePoint::sortPipes() {
+    auto lessThan = [](const ServicePoint *a, const ServicePoint *b) {
+        return a->getId() < b->getId() || (a->getId() == b->getId() && a->getCode() < b->getCode());
+    };
+    stable_sort(adj.begin(), adj.end(), [&](Edge<string> *a, Edge<string> *b) {
+        return lessThan(dynamic_cast<ServicePoint*>(a->getDest()), dynamic_cast<ServicePoint*>(b->getDest()));
+    });
+    stable_sort(incoming.begin(), incoming.end(), [&](Edge<string> *a, Edge<string> *b) {
+        return lessThan(dynamic_cast<ServicePoint*>(a->getOrig()), dynamic_cast<ServicePoint*>(b->getOrig()));
+    });
+}
+
 bool ServicePoint::isHidden() const {
     return hidden;
 }
@@ -0,0 +1,857 @@
+#include "SolverVerifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <unordered_set>
+#include <iterator>
+#include "ParallelBfs.h"
+#include "ReportWriter.h"
+#include "ScenarioResultStore.h"
+#include "TimeProfile.h"
+
+using namespace std;
+
+/**
+ * @brief Suffixes of the files of a network, in the order of the arguments of WaterSupplyNetwork::parseData
+ */
+static const char *const FILE_SUFFIXES[] = {"_reservoirs.csv", "_stations.csv", "_cities.csv", "_pipes.csv"};
+
+/**
+ * @brief Suffix of the file of the time profile of a network
+ */
+static const char *const PROFILE_SUFFIX = "_profile.csv";
+
+/**
+ * @brief Suffix of the file where the result stores of a network are saved and loaded back
+ */
+static const char *const STORE_SUFFIX = "_store.bin";
+
+/**
+ * @brief Suffix of the files where the reports are written and read back, followed by the extension of each format
+ */
+static const char *const REPORT_SUFFIX = "_report";
+
+/**
+ * @brief Number of steps of the time profile of a network
+ */
+static const int NUM_PROFILE_STEPS = 3;
+
+/**
+ * @brief Largest number of simultaneous failures whose worst combination is checked against the brute force
+ */
+static const int MAX_FAILURES = 3;
+
+/**
+ * @brief Largest number of combinations of failures evaluated by the brute force in a network, which checks fewer
+ * simultaneous failures in the networks with more elements
+ */
+static const uint64_t MAX_BRUTE_FORCE_COMBINATIONS = 2000;
+
+/**
+ * @brief Number of threads of the parallel runs, compared with the runs in one thread
+ */
+static const unsigned NUM_THREADS = 4;
+
+/**
+ * @brief Number of reservoirs of the large network, and of pumping stations in each of its layers, above the number of
+ * active service points for which push relabel discharges them in several threads
+ */
+static const int LARGE_WIDTH = 5000;
+
+/**
+ * @brief Number of layers of pumping stations of the large network, enough for it to reach ParallelBfs::MIN_VERTICES
+ */
+static const int LARGE_LAYERS = 10;
+
+/**
+ * @brief Number of cities of the large network
+ */
+static const int LARGE_CITIES = 4;
+
+/**
+ * @brief Relative precision of the demand breakpoints of the large network, coarse enough for a few bisections
+ */
+static const double LARGE_BREAKPOINT_TOLERANCE = 1e-2;
+
+/**
+ * @brief Returns the text of a flow, for the details of the failures
+ * @param flow Flow to write
+ * @return Text of the flow
+ */
+static string flowToString(double flow) {
+    ostringstream ss;
+    ss << flow;
+    return ss.str();
+}
+
+/**
+ * @brief Returns the text of a pipe, for the details of the failures
+ * @param pipe Pointer to the pipe
+ * @return Codes of the ends of the pipe
+ */
+static string pipeToString(const Pipe *pipe) {
+    return pipe->getOrig()->getCode() + "->" + pipe->getDest()->getCode();
+}
+
+/**
+ * @brief Returns the pipe of a city to the super sink, or of a reservoir from the super source
+ * @param sp Pointer to the city or the reservoir
+ * @return Pointer to the pipe, whose capacity is the demand of the city or the maximum delivery of the reservoir
+ */
+static Pipe *getSuperPipe(const ServicePoint *sp) {
+    for (Pipe *pipe: sp->getAdj()) {
+        if (pipe->getDest()->getId() == 0)
+            return pipe;
+    }
+    for (Pipe *pipe: sp->getIncoming()) {
+        if (pipe->getOrig()->getId() == 0)
+            return pipe;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Returns whether a city passes water on through a unidirectional pipe, which counts in its supply
+ * @param city Pointer to the city
+ * @return True if the city has a unidirectional pipe to a service point other than the super sink, false otherwise
+ */
+static bool passesWaterOn(const DeliverySite *city) {
+    for (Pipe *pipe: city->getAdj()) {
+        if (pipe->getDest()->getId() != 0 && pipe->getReverse() == nullptr)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the first difference between two result stores, for the details of the failures
+ * @param store Store that was saved
+ * @param loaded Store loaded from the file of the first one
+ * @return Description of the first difference, or an empty string if the stores hold the same values
+ */
+static string compareStores(const ScenarioResultStore &store, const ScenarioResultStore &loaded) {
+    if (loaded.getNumCities() != store.getNumCities() || loaded.getNumScenarios() != store.getNumScenarios())
+        return "the loaded store has " + to_string(loaded.getNumCities()) + " cities and "
+               + to_string(loaded.getNumScenarios()) + " scenarios instead of " + to_string(store.getNumCities())
+               + " and " + to_string(store.getNumScenarios());
+    for (int column = 0; column < store.getNumCities(); column++) {
+        if (loaded.getCityId(column) != store.getCityId(column) || loaded.getCityCode(column) != store.getCityCode(column)
+            || loaded.getBaseline()[column] != store.getBaseline()[column])
+            return "column " + to_string(column) + " has another city or baseline";
+    }
+    // The values are saved as bits, so they must come back exactly
+    for (size_t row = 0; row < store.getNumScenarios(); row++) {
+        if (loaded.getScenarioName(row) != store.getScenarioName(row))
+            return "row " + to_string(row) + " is named " + loaded.getScenarioName(row);
+        for (int column = 0; column < store.getNumCities(); column++) {
+            if (loaded.getSupply(row, column) != store.getSupply(row, column))
+                return "row " + to_string(row) + " of " + store.getCityCode(column) + " is "
+                       + flowToString(loaded.getSupply(row, column)) + " instead of "
+                       + flowToString(store.getSupply(row, column));
+        }
+    }
+    return "";
+}
+
+SolverVerifier::SolverVerifier(unsigned long seed, const string &directory) : seed(seed), directory(directory),
+                                                                              random(seed) {
+    if (this->directory.empty()) {
+        const char *temporary = getenv("TMPDIR");
+        this->directory = temporary != nullptr && *temporary != '\0' ? temporary : "/tmp";
+    }
+}
+
+void SolverVerifier::generateNetwork(const string &prefix) {
+    auto uniform = [&](int low, int high) {
+        return uniform_int_distribution<int>(low, high)(random);
+    };
+    ofstream reservoirs(prefix + FILE_SUFFIXES[0]), stations(prefix + FILE_SUFFIXES[1]);
+    ofstream cities(prefix + FILE_SUFFIXES[2]), pipes(prefix + FILE_SUFFIXES[3]);
+    reservoirs << "Reservoir,Municipality,Id,Code,Maximum Delivery (m3/sec),,\n";
+    stations << "Id,Code,,\n";
+    cities << "City,Id,Code,Demand,Population\n";
+    pipes << "Service_Point_A,Service_Point_B,Capacity,Direction\n";
+
+    // Each part is a random tree over its service points, with a few more pipes to close some cycles
+    int numReservoirs = 0, numStations = 0, numCities = 0, numParts = uniform(1, 3);
+    for (int part = 0; part < numParts; part++) {
+        vector<string> codes;
+        for (int i = uniform(1, 3); i > 0; i--) {
+            numReservoirs++;
+            codes.push_back("R_" + to_string(numReservoirs));
+            reservoirs << "Reservoir " << numReservoirs << ",Municipality " << numReservoirs << ',' << numReservoirs
+                       << ",R_" << numReservoirs << ',' << uniform(5, 60) << ",,\n";
+        }
+        for (int i = uniform(0, 6); i > 0; i--) {
+            numStations++;
+            codes.push_back("PS_" + to_string(numStations));
+            stations << numStations << ",PS_" << numStations << ',';
+            if (uniform(0, 1) == 0)
+                stations << uniform(1, 5);
+            stations << ',';
+            if (uniform(0, 2) == 0)
+                stations << uniform(5, 50);
+            stations << '\n';
+        }
+        for (int i = uniform(1, 4); i > 0; i--) {
+            numCities++;
+            codes.push_back("C_" + to_string(numCities));
+            cities << "City " << numCities << ',' << numCities << ",C_" << numCities << ',' << uniform(5, 60)
+                   << ",\"1,000\"\n";
+        }
+        shuffle(codes.begin(), codes.end(), random);
+
+        set<pair<string, string>> linked;
+        auto addPipe = [&](string a, string b) {
+            if (a == b || linked.count({a, b}) || linked.count({b, a}))
+                return;
+            bool bidirectional = uniform(0, 2) == 0;
+            // Most of the unidirectional pipes of the cities bring water to them, and none brings water to a reservoir
+            if (!bidirectional && a[0] == 'C' && uniform(0, 9) < 7)
+                swap(a, b);
+            if (!bidirectional && b[0] == 'R')
+                swap(a, b);
+            linked.insert({a, b});
+            pipes << a << ',' << b << ',' << uniform(1, 40) << ',' << (bidirectional ? 0 : 1);
+            if (uniform(0, 1) == 0)
+                pipes << ',' << uniform(1, 9);
+            pipes << '\n';
+        };
+        for (size_t i = 1; i < codes.size(); i++)
+            addPipe(codes[uniform(0, (int)i - 1)], codes[i]);
+        for (int i = uniform(0, (int)codes.size()); i > 0 && codes.size() > 1; i--)
+            addPipe(codes[uniform(0, (int)codes.size() - 1)], codes[uniform(0, (int)codes.size() - 1)]);
+    }
+}
+
+void SolverVerifier::generateLargeNetwork(const string &prefix) {
+    auto uniform = [&](int low, int high) {
+        return uniform_int_distribution<int>(low, high)(random);
+    };
+    ofstream reservoirs(prefix + FILE_SUFFIXES[0]), stations(prefix + FILE_SUFFIXES[1]);
+    ofstream cities(prefix + FILE_SUFFIXES[2]), pipes(prefix + FILE_SUFFIXES[3]);
+    reservoirs << "Reservoir,Municipality,Id,Code,Maximum Delivery (m3/sec),,\n";
+    stations << "Id,Code,,\n";
+    cities << "City,Id,Code,Demand,Population\n";
+    pipes << "Service_Point_A,Service_Point_B,Capacity,Direction\n";
+
+    // Each reservoir feeds its column of stations, and each station also feeds a random one of the next layer and is
+    // linked to its neighbour in the layer, so the paths to the cities cross the whole network. Only a few stations of
+    // the last layer feed the cities, which keeps the max flow (and the number of paths of Edmonds-Karp) small
+    auto station = [](int layer, int column) {
+        return "PS_" + to_string(layer * LARGE_WIDTH + column + 1);
+    };
+    for (int column = 0; column < LARGE_WIDTH; column++) {
+        reservoirs << "Reservoir " << column + 1 << ",Municipality " << column + 1 << ',' << column + 1 << ",R_"
+                   << column + 1 << ',' << uniform(5, 9) << ",,\n";
+        pipes << "R_" << column + 1 << ',' << station(0, column) << ',' << uniform(5, 9) << ",1\n";
+    }
+    for (int layer = 0; layer < LARGE_LAYERS; layer++) {
+        for (int column = 0; column < LARGE_WIDTH; column++) {
+            stations << layer * LARGE_WIDTH + column + 1 << ',' << station(layer, column) << ",,\n";
+            if (uniform(0, 3) == 0)
+                pipes << station(layer, column) << ',' << station(layer, (column + 1) % LARGE_WIDTH) << ','
+                      << uniform(1, 5) << ",0\n";
+            if (layer + 1 == LARGE_LAYERS) {
+                if (column < 2 * LARGE_CITIES)
+                    pipes << station(layer, column) << ",C_" << column % LARGE_CITIES + 1 << ',' << uniform(5, 9)
+                          << ",1\n";
+                continue;
+            }
+            int other = uniform(0, LARGE_WIDTH - 1);
+            pipes << station(layer, column) << ',' << station(layer + 1, column) << ',' << uniform(5, 9) << ",1\n";
+            if (other != column)
+                pipes << station(layer, column) << ',' << station(layer + 1, other) << ',' << uniform(5, 9) << ",1\n";
+        }
+    }
+    for (int city = 1; city <= LARGE_CITIES; city++)
+        cities << "City " << city << ',' << city << ",C_" << city << ',' << uniform(5, 15) << ",\"1,000\"\n";
+}
+
+void SolverVerifier::expect(bool holds, const string &check, const string &detail, unsigned network,
+                            const string &prefix, VerificationReport &report) {
+    report.numChecks++;
+    if (!holds)
+        report.failures.push_back({network, prefix, check, detail});
+}
+
+void SolverVerifier::checkFlow(WaterSupplyNetwork &wsn, const string &algorithm, double flow, unsigned network,
+                               const string &prefix, VerificationReport &report) {
+    double tolerance = WaterSupplyNetwork::getFlowTolerance(flow);
+    vector<Pipe*> pipes;
+    for (ServicePoint *sp: wsn.getServicePoints()) {
+        for (Pipe *pipe: sp->getAdj())
+            pipes.push_back(pipe);
+    }
+    auto usable = [](const Pipe *pipe) {
+        return !pipe->isHidden() && !pipe->getOrig()->isHidden() && !pipe->getDest()->isHidden();
+    };
+
+    // The super source and the super sink are the only service points with id 0, and only the first has pipes out
+    string capacityDetail, hiddenDetail;
+    ServicePoint *superSource = nullptr;
+    double sinkInflow = 0;
+    for (Pipe *pipe: pipes) {
+        double pipeFlow = pipe->getFlow();
+        bool withinCapacity = pipeFlow <= pipe->getCapacity() + tolerance;
+        if (pipe->getReverse() == nullptr)
+            withinCapacity = withinCapacity && pipeFlow >= -tolerance;
+        else
+            withinCapacity = withinCapacity && fabs(pipeFlow + pipe->getReverse()->getFlow()) <= tolerance;
+        if (!withinCapacity && capacityDetail.empty())
+            capacityDetail = pipeToString(pipe) + " carries " + flowToString(pipeFlow) + " of "
+                             + flowToString(pipe->getCapacity());
+        if (!usable(pipe) && fabs(pipeFlow) > tolerance && hiddenDetail.empty())
+            hiddenDetail = pipeToString(pipe) + " is hidden and carries " + flowToString(pipeFlow);
+        if (pipe->getOrig()->getId() == 0)
+            superSource = pipe->getOrig();
+        if (pipe->getDest()->getId() == 0)
+            sinkInflow += pipeFlow;
+    }
+    expect(capacityDetail.empty(), "Capacity", algorithm + ": " + capacityDetail, network, prefix, report);
+    expect(hiddenDetail.empty(), "Hidden Elements", algorithm + ": " + hiddenDetail, network, prefix, report);
+    expect(fabs(sinkInflow - flow) <= tolerance, "Flow Value",
+           algorithm + ": returned " + flowToString(flow) + " but delivered " + flowToString(sinkInflow), network,
+           prefix, report);
+
+    // The flow out of a pipe that has a reverse is already the negative of the flow into it
+    string conservationDetail;
+    for (ServicePoint *sp: wsn.getServicePoints()) {
+        if (sp->getId() == 0)
+            continue;
+        double netFlow = 0;
+        for (Pipe *pipe: sp->getAdj())
+            netFlow += pipe->getFlow();
+        for (Pipe *pipe: sp->getIncoming()) {
+            if (pipe->getReverse() == nullptr)
+                netFlow -= pipe->getFlow();
+        }
+        if (fabs(netFlow) > tolerance && conservationDetail.empty())
+            conservationDetail = sp->getCode() + " has a net outflow of " + flowToString(netFlow);
+    }
+    expect(conservationDetail.empty(), "Conservation", algorithm + ": " + conservationDetail, network, prefix, report);
+
+    // The service points reached from the super source in the residual network are one side of a cut, which must be
+    // saturated (and must not contain the super sink) when the flow is maximum
+    unordered_set<const ServicePoint*> reached;
+    vector<const ServicePoint*> queue;
+    if (superSource != nullptr) {
+        reached.insert(superSource);
+        queue.push_back(superSource);
+    }
+    bool sinkReached = false;
+    for (size_t head = 0; head < queue.size(); head++) {
+        const ServicePoint *u = queue[head];
+        auto visit = [&](const ServicePoint *v) {
+            if (reached.insert(v).second) {
+                queue.push_back(v);
+                sinkReached = sinkReached || v->getId() == 0;
+            }
+        };
+        for (Pipe *pipe: u->getAdj()) {
+            if (usable(pipe) && pipe->getCapacity() - pipe->getFlow() > tolerance)
+                visit(pipe->getDest());
+        }
+        for (Pipe *pipe: u->getIncoming()) {
+            if (usable(pipe) && pipe->getReverse() == nullptr && pipe->getFlow() > tolerance)
+                visit(pipe->getOrig());
+        }
+    }
+    double cutCapacity = 0;
+    for (Pipe *pipe: pipes) {
+        if (usable(pipe) && reached.count(pipe->getOrig()) && !reached.count(pipe->getDest()))
+            cutCapacity += pipe->getCapacity();
+    }
+    expect(!sinkReached && fabs(cutCapacity - flow) <= tolerance, "Min Cut",
+           algorithm + (sinkReached ? ": an augmenting path is left"
+                                    : ": max flow " + flowToString(flow) + " but min cut " + flowToString(cutCapacity)),
+           network, prefix, report);
+}
+
+void SolverVerifier::agree(const string &algorithm, double value, const string &reference, double expected,
+                           unsigned network, const string &prefix, VerificationReport &report) {
+    expect(fabs(value - expected) <= WaterSupplyNetwork::getFlowTolerance(expected), "Equal Totals",
+           algorithm + " found " + flowToString(value) + " but " + reference + " found " + flowToString(expected),
+           network, prefix, report);
+}
+
+void SolverVerifier::verifyNetwork(WaterSupplyNetwork &wsn, unsigned network, const string &prefix,
+                                   VerificationReport &report) {
+    auto agreeWith = [&](const string &algorithm, double value, const string &reference, double expected) {
+        agree(algorithm, value, reference, expected, network, prefix, report);
+    };
+
+    double flow = wsn.getMaxFlow(false, MAX_FLOW_EDMONDS_KARP);
+    checkFlow(wsn, "Edmonds-Karp", flow, network, prefix, report);
+    double pushRelabelFlow = wsn.getMaxFlow(false, MAX_FLOW_PUSH_RELABEL);
+    checkFlow(wsn, "Push Relabel", pushRelabelFlow, network, prefix, report);
+    agreeWith("Push Relabel", pushRelabelFlow, "Edmonds-Karp", flow);
+    double cost;
+    double minCostFlow = wsn.getMinCostMaxFlow(cost);
+    checkFlow(wsn, "Minimum Cost", minCostFlow, network, prefix, report);
+    agreeWith("Minimum Cost", minCostFlow, "Edmonds-Karp", flow);
+    double cachedFlow = wsn.loadCachedMaxFlow();
+    checkFlow(wsn, "Cached", cachedFlow, network, prefix, report);
+    agreeWith("Cached", cachedFlow, "Edmonds-Karp", flow);
+    double componentsFlow = 0;
+    for (double componentFlow: wsn.getComponentFlows())
+        componentsFlow += componentFlow;
+    agreeWith("Components", componentsFlow, "Edmonds-Karp", flow);
+
+    // Each failure is checked right after it is evaluated, before its hidden elements are restored
+    auto evaluate = [&](const string &algorithm, const function<double()> &maxFlowWithout) {
+        double value = maxFlowWithout();
+        checkFlow(wsn, algorithm, value, network, prefix, report);
+        wsn.unhideAllPipes();
+        wsn.unhideAllServicePoints();
+        return value;
+    };
+    auto compare = [&](const string &element, double bruteForceFlow, const vector<pair<string, double>> &others) {
+        expect(bruteForceFlow <= flow + WaterSupplyNetwork::getFlowTolerance(flow), "Failure Bound",
+               "Brute-force without " + element + " found " + flowToString(bruteForceFlow) + ", more than "
+               + flowToString(flow), network, prefix, report);
+        for (const pair<string, double> &other: others)
+            agreeWith(other.first + " without " + element, other.second, "brute-force", bruteForceFlow);
+    };
+
+    wsn.forEachFailureElement(
+            [&](Pipe *pipe) {
+                string element = WaterSupplyNetwork::getPipeDescription(pipe);
+                double incremental = evaluate("Incremental without " + element,
+                                              [&]() { return wsn.getMaxFlowWithoutPipes({pipe}); });
+                double components = evaluate("Components without " + element,
+                                             [&]() { return wsn.getMaxFlowWithoutPipesInComponents({pipe}); });
+                double bruteForce = evaluate("Brute-force without " + element,
+                                             [&]() { return wsn.getMaxFlowWithoutPipesBF({pipe}); });
+                compare(element, bruteForce, {{"Incremental", incremental}, {"Components", components}});
+            },
+            [&](Reservoir *reservoir) {
+                string element = reservoir->getCode();
+                double incremental = evaluate("Incremental without " + element,
+                                              [&]() { return wsn.getMaxFlowWithoutReservoir(reservoir); });
+                double bruteForce = evaluate("Brute-force without " + element,
+                                             [&]() { return wsn.getMaxFlowWithoutReservoirBF(reservoir); });
+                compare(element, bruteForce, {{"Incremental", incremental}});
+            },
+            [&](PumpingStation *station) {
+                string element = station->getCode();
+                double incremental = evaluate("Incremental without " + element,
+                                              [&]() { return wsn.getMaxFlowWithoutStation(station); });
+                double bruteForce = evaluate("Brute-force without " + element,
+                                             [&]() { return wsn.getMaxFlowWithoutStationBF(station); });
+                compare(element, bruteForce, {{"Incremental", incremental}});
+            });
+
+    verifyWarmStart(wsn, network, prefix, report);
+    verifyBalancing(wsn, network, prefix, report);
+    verifyResultStore(wsn, network, prefix, report);
+    verifyWorstFailures(wsn, network, prefix, report);
+    verifyCriticalPipes(wsn, network, prefix, report);
+    verifyDemandBreakpoints(wsn, network, prefix, report);
+    verifyTimeSeries(wsn, network, prefix, report);
+}
+
+void SolverVerifier::verifyWarmStart(WaterSupplyNetwork &wsn, unsigned network, const string &prefix,
+                                     VerificationReport &report) {
+    wsn.getMaxFlow();
+    vector<double> maxFlows = wsn.getPipeFlows();
+    Pipe *busiest = nullptr;
+    for (ServicePoint *sp: wsn.getServicePoints()) {
+        for (Pipe *pipe: sp->getAdj()) {
+            if (busiest == nullptr || pipe->getFlow() > busiest->getFlow())
+                busiest = pipe;
+        }
+    }
+
+    // The max flow no longer fits once the busiest pipe loses half of its flow, so it must be repaired first
+    if (busiest != nullptr && busiest->getFlow() > WaterSupplyNetwork::getFlowTolerance(busiest->getFlow())) {
+        double capacity = busiest->getCapacity();
+        wsn.setPipeCapacity(busiest, busiest->getFlow() / 2);
+        string algorithm = "Warm start without half of " + pipeToString(busiest);
+        double coldFlow = wsn.getMaxFlow();
+        double warmFlow = wsn.getMaxFlowFrom(maxFlows);
+        checkFlow(wsn, algorithm, warmFlow, network, prefix, report);
+        agree(algorithm, warmFlow, "Edmonds-Karp", coldFlow, network, prefix, report);
+        wsn.setPipeCapacity(busiest, capacity);
+    }
+
+    // Half of the minimum cost flow is feasible but unrelated to the paths Edmonds-Karp would find
+    double cost;
+    wsn.getMinCostMaxFlow(cost);
+    vector<double> halfFlows = wsn.getPipeFlows();
+    for (double &pipeFlow: halfFlows)
+        pipeFlow /= 2;
+    double coldFlow = wsn.getMaxFlow();
+    double warmFlow = wsn.getMaxFlowFrom(halfFlows);
+    checkFlow(wsn, "Warm start from half of the minimum cost flow", warmFlow, network, prefix, report);
+    agree("Warm start from half of the minimum cost flow", warmFlow, "Edmonds-Karp", coldFlow, network, prefix, report);
+}
+
+void SolverVerifier::verifyBalancing(WaterSupplyNetwork &wsn, unsigned network, const string &prefix,
+                                     VerificationReport &report) {
+    double flow = wsn.loadCachedMaxFlow();
+    tuple<double, double, double> before, after;
+    wsn.getMetrics(before);
+    wsn.balance();
+    wsn.getMetrics(after);
+    // The balanced flow must still be a max flow of the same value, only spread differently
+    checkFlow(wsn, "Balancing", flow, network, prefix, report);
+    expect(get<2>(after) <= get<2>(before) + WaterSupplyNetwork::getFlowTolerance(get<2>(before)), "Balancing Variance",
+           "The variance of the differences grew from " + flowToString(get<2>(before)) + " to "
+           + flowToString(get<2>(after)), network, prefix, report);
+}
+
+void SolverVerifier::verifyResultStore(WaterSupplyNetwork &wsn, unsigned network, const string &prefix,
+                                       VerificationReport &report) {
+    // Besides a sweep, a store without cities, one without scenarios and one whose rows are all the baseline (so every
+    // column is a single run of zeros)
+    ScenarioResultStore sweep, empty, unaffected, withoutScenarios;
+    wsn.sweepFailures(sweep);
+    unaffected.setCities(wsn.getDeliverySites());
+    unaffected.setBaseline(sweep.getBaseline());
+    for (int row = 0; row < 3; row++)
+        unaffected.appendScenario("Baseline " + to_string(row + 1), sweep.getBaseline());
+    withoutScenarios.setCities(wsn.getDeliverySites());
+    withoutScenarios.setBaseline(sweep.getBaseline());
+
+    vector<pair<string, const ScenarioResultStore*>> stores = {
+            {"Failure sweep", &sweep}, {"Empty store", &empty}, {"Baseline rows", &unaffected},
+            {"No scenarios", &withoutScenarios}};
+    for (const pair<string, const ScenarioResultStore*> &store: stores) {
+        ScenarioResultStore loaded;
+        bool roundTrip = store.second->save(prefix + STORE_SUFFIX) && loaded.load(prefix + STORE_SUFFIX);
+        string detail = roundTrip ? compareStores(*store.second, loaded) : "the file could not be saved or loaded";
+        expect(detail.empty(), "Store Round Trip", store.first + ": " + detail, network, prefix, report);
+    }
+}
+
+void SolverVerifier::verifyWorstFailures(WaterSupplyNetwork &wsn, unsigned network, const string &prefix,
+                                         VerificationReport &report) {
+    // Each element is hidden like in the brute-force functions of the network: a pipe with its other direction, and a
+    // service point with all its pipes
+    vector<function<void()>> hideElements;
+    wsn.forEachFailureElement(
+            [&](Pipe *pipe) {
+                hideElements.push_back([pipe]() {
+                    for (Pipe *direction: {pipe, pipe->getReverse(), pipe->getTwin()}) {
+                        if (direction != nullptr)
+                            direction->setHidden(true);
+                    }
+                });
+            },
+            [&](Reservoir *reservoir) { hideElements.push_back([reservoir]() { reservoir->setHidden(true); }); },
+            [&](PumpingStation *station) { hideElements.push_back([station]() { station->setHidden(true); }); });
+
+    // The combinations of up to k elements are counted as C(n, k) + C(n, k - 1) + ...
+    size_t maxFailures = 0;
+    uint64_t numCombinations = 0, numSubsets = 1;
+    for (size_t k = 1; k <= MAX_FAILURES && k <= hideElements.size(); k++) {
+        numSubsets = numSubsets * (hideElements.size() - k + 1) / k;
+        numCombinations += numSubsets;
+        if (numCombinations > MAX_BRUTE_FORCE_COMBINATIONS)
+            break;
+        maxFailures = k;
+    }
+
+    // worstFlows[m] is the lowest max flow without up to m elements
+    vector<double> worstFlows(maxFailures + 1, wsn.getMaxFlow());
+    vector<int> combination;
+    function<void(int)> enumerate = [&](int next) {
+        if (!combination.empty()) {
+            for (int e: combination)
+                hideElements[e]();
+            double flow = wsn.getMaxFlow();
+            wsn.unhideAllPipes();
+            wsn.unhideAllServicePoints();
+            for (size_t m = combination.size(); m <= maxFailures; m++)
+                worstFlows[m] = min(worstFlows[m], flow);
+        }
+        if (combination.size() == maxFailures)
+            return;
+        for (int e = next; e < (int)hideElements.size(); e++) {
+            combination.push_back(e);
+            enumerate(e + 1);
+            combination.pop_back();
+        }
+    };
+    enumerate(0);
+
+    for (int k = 1; k <= (int)maxFailures; k++) {
+        FailureReport failureReport = wsn.getWorstFailures(k);
+        string algorithm = "N-" + to_string(k) + " analysis";
+        agree(algorithm, failureReport.worstFlow, "brute-force", worstFlows[k], network, prefix, report);
+        expect(failureReport.numPruned + failureReport.numEvaluated == failureReport.numCombinations,
+               "Failure Combinations", algorithm + ": " + to_string(failureReport.numPruned) + " pruned and "
+               + to_string(failureReport.numEvaluated) + " evaluated of " + to_string(failureReport.numCombinations),
+               network, prefix, report);
+    }
+}
+
+void SolverVerifier::verifyCriticalPipes(WaterSupplyNetwork &wsn, unsigned network, const string &prefix,
+                                         VerificationReport &report) {
+    vector<DeliverySite*> cities = wsn.getDeliverySites();
+    vector<Pipe*> demandPipes;
+    vector<double> demands;
+    for (DeliverySite *city: cities) {
+        demandPipes.push_back(getSuperPipe(city));
+        demands.push_back(demandPipes.back()->getCapacity());
+    }
+
+    for (size_t i = 0; i < cities.size(); i++) {
+        DeliverySite *city = cities[i];
+        vector<Pipe*> critical = wsn.getCriticalPipesToCity(city, 1);
+        expect(wsn.getCriticalPipesToCity(city, NUM_THREADS) == critical, "Critical Pipes Threads",
+               city->getCode() + ": the critical pipes found in " + to_string(NUM_THREADS)
+               + " threads differ from the ones found in one", network, prefix, report);
+
+        // With the other cities without demand, the max flow without a pipe is all the city can get without it
+        wsn.loadCachedMaxFlow();
+        double supply = city->getSupplyRate(), tolerance = WaterSupplyNetwork::getFlowTolerance(supply);
+        if (supply <= tolerance || passesWaterOn(city))
+            continue;
+        for (size_t j = 0; j < cities.size(); j++) {
+            if (j != i)
+                wsn.setPipeCapacity(demandPipes[j], 0);
+        }
+        unordered_set<const Pipe*> criticalPipes(critical.begin(), critical.end());
+        string detail;
+        wsn.forEachFailureElement(
+                [&](Pipe *pipe) {
+                    double flow = wsn.getMaxFlowWithoutPipesBF({pipe});
+                    wsn.unhideAllPipes();
+                    wsn.unhideAllServicePoints();
+                    bool listed = criticalPipes.count(pipe) || criticalPipes.count(pipe->getReverse())
+                                  || criticalPipes.count(pipe->getTwin());
+                    if (flow < supply - tolerance && !listed && detail.empty())
+                        detail = city->getCode() + " gets only " + flowToString(flow) + " of " + flowToString(supply)
+                                 + " without " + pipeToString(pipe) + ", which is not critical";
+                },
+                [](Reservoir*) {}, [](PumpingStation*) {});
+        for (size_t j = 0; j < cities.size(); j++) {
+            if (j != i)
+                wsn.setPipeCapacity(demandPipes[j], demands[j]);
+        }
+        expect(detail.empty(), "Critical Pipes", detail, network, prefix, report);
+    }
+}
+
+void SolverVerifier::verifyDemandBreakpoints(WaterSupplyNetwork &wsn, unsigned network, const string &prefix,
+                                             VerificationReport &report) {
+    vector<DeliverySite*> cities = wsn.getDeliverySites();
+    vector<pair<DeliverySite*, double>> breakpoints = wsn.getDemandBreakpoints();
+    bool sorted = breakpoints.size() == cities.size();
+    for (size_t i = 1; i < breakpoints.size(); i++)
+        sorted = sorted && breakpoints[i - 1].second <= breakpoints[i].second;
+    expect(sorted, "Breakpoints Order", "The factors are not sorted or do not cover every city", network, prefix,
+           report);
+
+    vector<Pipe*> demandPipes;
+    vector<double> demands;
+    for (DeliverySite *city: cities) {
+        demandPipes.push_back(getSuperPipe(city));
+        demands.push_back(demandPipes.back()->getCapacity());
+    }
+    string detail;
+    for (const pair<DeliverySite*, double> &breakpoint: breakpoints) {
+        if (isinf(breakpoint.second))
+            continue;
+        for (size_t i = 0; i < cities.size(); i++)
+            wsn.setPipeCapacity(demandPipes[i], demands[i] * breakpoint.second);
+        Pipe *demandPipe = getSuperPipe(breakpoint.first);
+        for (MaxFlowAlgorithm algorithm: {MAX_FLOW_EDMONDS_KARP, MAX_FLOW_PUSH_RELABEL}) {
+            double flow = wsn.getMaxFlow(false, algorithm);
+            if (demandPipe->getFlow() < demandPipe->getCapacity() - WaterSupplyNetwork::getFlowTolerance(flow)
+                && detail.empty())
+                detail = breakpoint.first->getCode() + " gets " + flowToString(demandPipe->getFlow()) + " of "
+                         + flowToString(demandPipe->getCapacity()) + " with the demands scaled by "
+                         + flowToString(breakpoint.second);
+        }
+    }
+    for (size_t i = 0; i < cities.size(); i++)
+        wsn.setPipeCapacity(demandPipes[i], demands[i]);
+    expect(detail.empty(), "Breakpoints", detail, network, prefix, report);
+}
+
+void SolverVerifier::verifyTimeSeries(WaterSupplyNetwork &wsn, unsigned network, const string &prefix,
+                                      VerificationReport &report) {
+    // Each reservoir and city gets up to twice its static value in each step
+    vector<ServicePoint*> rows;
+    for (Reservoir *reservoir: wsn.getReservoirs())
+        rows.push_back(reservoir);
+    for (DeliverySite *city: wsn.getDeliverySites())
+        rows.push_back(city);
+    vector<Pipe*> rowPipes;
+    vector<double> capacities;
+    vector<vector<int>> values(rows.size());
+    ofstream file(prefix + PROFILE_SUFFIX);
+    file << "Code";
+    for (int step = 0; step < NUM_PROFILE_STEPS; step++)
+        file << ",Step " << step + 1;
+    file << '\n';
+    for (size_t row = 0; row < rows.size(); row++) {
+        rowPipes.push_back(getSuperPipe(rows[row]));
+        capacities.push_back(rowPipes.back()->getCapacity());
+        file << rows[row]->getCode();
+        for (int step = 0; step < NUM_PROFILE_STEPS; step++) {
+            values[row].push_back(uniform_int_distribution<int>(0, (int)(2 * capacities[row]))(random));
+            file << ',' << values[row].back();
+        }
+        file << '\n';
+    }
+    file.close();
+
+    double flow = wsn.loadCachedMaxFlow();
+    TimeProfile profile;
+    ScenarioResultStore store;
+    bool simulated = profile.load(prefix + PROFILE_SUFFIX) && wsn.simulateTimeSeries(profile, store);
+    expect(simulated && store.getNumScenarios() == NUM_PROFILE_STEPS, "Time Series", "The profile was not simulated",
+           network, prefix, report);
+    double restoredFlow = wsn.loadCachedMaxFlow();
+    expect(fabs(restoredFlow - flow) <= WaterSupplyNetwork::getFlowTolerance(flow), "Time Series Restore",
+           "The max flow was " + flowToString(flow) + " before the simulation and " + flowToString(restoredFlow)
+           + " after it", network, prefix, report);
+    if (!simulated || store.getNumScenarios() != NUM_PROFILE_STEPS)
+        return;
+
+    // The supplies add up to the max flow, plus the water that the cities pass on through unidirectional pipes
+    bool passThrough = false;
+    for (DeliverySite *city: wsn.getDeliverySites())
+        passThrough = passThrough || passesWaterOn(city);
+    string detail;
+    for (int step = 0; step < NUM_PROFILE_STEPS; step++) {
+        for (size_t row = 0; row < rows.size(); row++)
+            wsn.setPipeCapacity(rowPipes[row], values[row][step]);
+        double expected = wsn.getMaxFlow(false, MAX_FLOW_EDMONDS_KARP), total = 0;
+        for (int column = 0; column < store.getNumCities(); column++)
+            total += store.getSupply(step, column);
+        double tolerance = WaterSupplyNetwork::getFlowTolerance(expected);
+        bool holds = passThrough ? total >= expected - tolerance : fabs(total - expected) <= tolerance;
+        if (!holds && detail.empty())
+            detail = "Step " + to_string(step + 1) + " supplies " + flowToString(total) + " but its max flow is "
+                     + flowToString(expected);
+    }
+    for (size_t row = 0; row < rows.size(); row++)
+        wsn.setPipeCapacity(rowPipes[row], capacities[row]);
+    expect(detail.empty(), "Time Series Supplies", detail, network, prefix, report);
+}
+
+void SolverVerifier::verifyParallelSolvers(WaterSupplyNetwork &wsn, unsigned network, const string &prefix,
+                                           VerificationReport &report) {
+    expect(wsn.getServicePoints().size() >= (size_t)ParallelBfs::MIN_VERTICES, "Network Size",
+           "The network has too few service points for the parallel BFS", network, prefix, report);
+
+    wsn.setMaxFlowThreads(1);
+    double flow = wsn.getMaxFlow(false, MAX_FLOW_EDMONDS_KARP);
+    checkFlow(wsn, "Edmonds-Karp", flow, network, prefix, report);
+    double pushRelabelFlow = wsn.getMaxFlow(false, MAX_FLOW_PUSH_RELABEL);
+    checkFlow(wsn, "Push Relabel", pushRelabelFlow, network, prefix, report);
+    agree("Push Relabel", pushRelabelFlow, "Edmonds-Karp", flow, network, prefix, report);
+    vector<pair<DeliverySite*, double>> breakpoints = wsn.getDemandBreakpoints(LARGE_BREAKPOINT_TOLERANCE);
+
+    // The parallel BFS finds the same parents as the sequential one, so the breakpoints must not change either
+    wsn.setMaxFlowThreads(NUM_THREADS);
+    string threads = " in " + to_string(NUM_THREADS) + " threads";
+    double parallelFlow = wsn.getMaxFlow(false, MAX_FLOW_EDMONDS_KARP);
+    checkFlow(wsn, "Edmonds-Karp" + threads, parallelFlow, network, prefix, report);
+    agree("Edmonds-Karp" + threads, parallelFlow, "Edmonds-Karp", flow, network, prefix, report);
+    double parallelPushRelabelFlow = wsn.getMaxFlow(false, MAX_FLOW_PUSH_RELABEL);
+    checkFlow(wsn, "Push Relabel" + threads, parallelPushRelabelFlow, network, prefix, report);
+    agree("Push Relabel" + threads, parallelPushRelabelFlow, "Edmonds-Karp", flow, network, prefix, report);
+    vector<pair<DeliverySite*, double>> parallelBreakpoints = wsn.getDemandBreakpoints(LARGE_BREAKPOINT_TOLERANCE);
+    expect(parallelBreakpoints == breakpoints, "Breakpoints Threads",
+           "The breakpoints found" + threads + " differ from the ones found in one", network, prefix, report);
+}
+
+void SolverVerifier::verifyFiles(unsigned network, const string &prefix,
+                                 const function<void(WaterSupplyNetwork &)> &verify, VerificationReport &report) {
+    size_t numFailures = report.failures.size();
+    {
+        WaterSupplyNetwork wsn;
+        bool parsed = wsn.parseData(prefix + FILE_SUFFIXES[0], prefix + FILE_SUFFIXES[1], prefix + FILE_SUFFIXES[2],
+                                    prefix + FILE_SUFFIXES[3]);
+        expect(parsed, "Parsing", "The files of the network could not be loaded", network, prefix, report);
+        if (parsed)
+            verify(wsn);
+    }
+    if (report.failures.size() == numFailures) {
+        for (const char *suffix: FILE_SUFFIXES)
+            remove((prefix + suffix).c_str());
+        remove((prefix + PROFILE_SUFFIX).c_str());
+        remove((prefix + STORE_SUFFIX).c_str());
+    }
+}
+
+void SolverVerifier::verifyReports(const string &prefix, VerificationReport &report) {
+    // The stored bytes of the numbers and counts of the binary format, in the byte order of the host
+    auto bytes = [](const void *data, size_t size) { return string((const char *)data, size); };
+    auto count = [&](uint32_t value) { return bytes(&value, sizeof(value)); };
+    auto number = [&](double value) { return bytes(&value, sizeof(value)); };
+    auto text = [&](const string &value) { return count((uint32_t)value.size()) + value; };
+    string binary = "WSNR" + text("First") + count(2) + count(2) + text("city") + '\x01' + text("C_1")
+                    + text("C, \"2\"") + text("flow") + '\x00' + number(1.5) + number(2) + text("Second") + count(1)
+                    + count(1) + text("total") + '\x00' + number(3.5);
+    vector<pair<ReportFormat, string>> expected = {
+            {REPORT_TEXT, "===>  First\nC_1,1.5\nC, \"2\",2\n===>  Second\n3.5\n"},
+            {REPORT_CSV, "section,city,flow\nFirst,C_1,1.5\nFirst,\"C, \"\"2\"\"\",2\nsection,total\nSecond,3.5\n"},
+            {REPORT_JSONL, "{\"section\":\"First\",\"city\":\"C_1\",\"flow\":1.5}\n"
+                           "{\"section\":\"First\",\"city\":\"C, \\\"2\\\"\",\"flow\":2}\n"
+                           "{\"section\":\"Second\",\"total\":3.5}\n"},
+            {REPORT_BINARY, binary}};
+
+    for (const pair<ReportFormat, string> &format: expected) {
+        // A file left by a previous run must be truncated, and the second section appended after the file is reopened
+        string path = prefix + REPORT_SUFFIX + ReportWriter::getExtension(format.first);
+        ofstream stale(path);
+        stale << "Stale report\n";
+        stale.close();
+        ReportWriter writer;
+        bool opened = writer.open(path, format.first);
+        writer.beginSection("First", {"city", "flow"});
+        writer.writeRow({"C_1", 1.5});
+        writer.writeRow({"C, \"2\"", 2});
+        writer.endSection();
+        writer.close();
+        opened = opened && writer.open(path, format.first);
+        writer.beginSection("Second", {"total"});
+        writer.writeRow({3.5});
+        writer.endSection();
+        writer.close();
+
+        ifstream file(path, ios::binary);
+        string contents((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        string formatName = ReportWriter::getFormatName(format.first);
+        expect(opened, "Report Sections", formatName + ": the file could not be opened", 0, prefix, report);
+        expect(contents == format.second, "Report Sections",
+               formatName + ": the file holds " + to_string(contents.size()) + " bytes instead of the "
+               + to_string(format.second.size()) + " expected ones", 0, prefix, report);
+        if (opened && contents == format.second)
+            remove(path.c_str());
+    }
+}
+
+VerificationReport SolverVerifier::run(unsigned numNetworks) {
+    VerificationReport report = {seed, numNetworks, 0, {}};
+    verifyReports(directory + "/verify_" + to_string(seed), report);
+    for (unsigned network = 0; network < numNetworks; network++) {
+        string prefix = directory + "/verify_" + to_string(seed) + "_" + to_string(network);
+        generateNetwork(prefix);
+        verifyFiles(network, prefix, [&](WaterSupplyNetwork &wsn) { verifyNetwork(wsn, network, prefix, report); },
+                    report);
+    }
+    return report;
+}
+
+VerificationReport SolverVerifier::runLarge() {
+    VerificationReport report = {seed, 1, 0, {}};
+    string prefix = directory + "/verify_" + to_string(seed) + "_large";
+    generateLargeNetwork(prefix);
+    verifyFiles(0, prefix, [&](WaterSupplyNetwork &wsn) { verifyParallelSolvers(wsn, 0, prefix, report); }, report);
+    return report;
+}
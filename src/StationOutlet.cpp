@@ -0,0 +1,13 @@
+#include "StationOutlet.h"
+#include "PumpingStation.h"
+
+StationOutlet::StationOutlet(PumpingStation *station)
+        : ServicePoint(station->getId(), station->getCode() + "_out"), station(station) {}
+
+std::string StationOutlet::getDescription() const {
+    return station->getDescription();
+}
+
+PumpingStation *StationOutlet::getStation() const {
+    return station;
+}
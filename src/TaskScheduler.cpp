@@ -0,0 +1,127 @@
+#include "TaskScheduler.h"
+
+#include <algorithm>
+
+using namespace std;
+
+TaskScheduler::WorkDeque::WorkDeque() : top(0), bottom(0) {}
+
+void TaskScheduler::WorkDeque::reset(size_t first, size_t last) {
+    // The tasks are stored backwards, so that the owner (at the bottom) runs them in increasing order
+    tasks.resize(last - first);
+    for (size_t i = 0; i < tasks.size(); i++)
+        tasks[i] = last - 1 - i;
+    top.store(0, memory_order_relaxed);
+    bottom.store((long)tasks.size(), memory_order_relaxed);
+}
+
+bool TaskScheduler::WorkDeque::pop(size_t &task) {
+    long b = bottom.load(memory_order_relaxed) - 1;
+    bottom.store(b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = top.load(memory_order_relaxed);
+    if (t > b) {
+        bottom.store(b + 1, memory_order_relaxed);
+        return false;
+    }
+
+    task = tasks[b];
+    if (t < b)
+        return true;
+    // Last task: race against the thieves for it
+    bool won = top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+    bottom.store(b + 1, memory_order_relaxed);
+    return won;
+}
+
+bool TaskScheduler::WorkDeque::steal(size_t &task) {
+    long t = top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = bottom.load(memory_order_acquire);
+    if (t >= b)
+        return false;
+
+    task = tasks[t];
+    return top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+TaskScheduler::TaskScheduler(unsigned numWorkers)
+        : numWorkers(numWorkers), remaining(0), batchTask(nullptr), batch(0), busyWorkers(0), stopping(false) {
+    if (this->numWorkers == 0)
+        this->numWorkers = max(1u, thread::hardware_concurrency());
+    for (unsigned w = 0; w < this->numWorkers; w++)
+        deques.push_back(unique_ptr<WorkDeque>(new WorkDeque()));
+    for (unsigned w = 1; w < this->numWorkers; w++)
+        threads.emplace_back(&TaskScheduler::serve, this, w);
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        lock_guard<mutex> lock(batchMutex);
+        stopping = true;
+    }
+    batchReady.notify_all();
+    for (thread &t: threads)
+        t.join();
+}
+
+unsigned TaskScheduler::getNumWorkers() const {
+    return numWorkers;
+}
+
+void TaskScheduler::work(unsigned worker, const function<void(size_t, unsigned)> &task) {
+    size_t current;
+    while (remaining.load(memory_order_acquire) > 0) {
+        bool found = deques[worker]->pop(current);
+        for (unsigned i = 1; i < numWorkers && !found; i++)
+            found = deques[(worker + i) % numWorkers]->steal(current);
+        if (!found) {
+            // The remaining tasks are being taken by other workers, or a steal lost a race
+            this_thread::yield();
+            continue;
+        }
+        remaining.fetch_sub(1, memory_order_acq_rel);
+        task(current, worker);
+    }
+}
+
+void TaskScheduler::serve(unsigned worker) {
+    unsigned long served = 0;
+    while (true) {
+        const function<void(size_t, unsigned)> *task;
+        {
+            unique_lock<mutex> lock(batchMutex);
+            batchReady.wait(lock, [&]() { return stopping || batch != served; });
+            if (stopping)
+                return;
+            served = batch;
+            task = batchTask;
+        }
+        work(worker, *task);
+        {
+            lock_guard<mutex> lock(batchMutex);
+            busyWorkers--;
+        }
+        batchDone.notify_one();
+    }
+}
+
+void TaskScheduler::run(size_t numTasks, const function<void(size_t task, unsigned worker)> &task) {
+    if (numTasks == 0)
+        return;
+    for (unsigned w = 0; w < numWorkers; w++)
+        deques[w]->reset(numTasks * w / numWorkers, numTasks * (w + 1) / numWorkers);
+    remaining.store(numTasks, memory_order_release);
+
+    {
+        lock_guard<mutex> lock(batchMutex);
+        batchTask = &task;
+        busyWorkers = numWorkers - 1;
+        batch++;
+    }
+    batchReady.notify_all();
+    work(0, task);
+    // The deques and the task must stay valid until every worker has left the batch
+    unique_lock<mutex> lock(batchMutex);
+    batchDone.wait(lock, [&]() { return busyWorkers == 0; });
+}
@@ -0,0 +1,95 @@
+#include "TimeProfile.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cmath>
+
+using namespace std;
+
+/**
+ * @brief Reads a value of a profile, which must be a finite number that is not negative
+ * @param cell Text of the cell
+ * @param value Variable that will hold the value
+ * @return True if the cell holds a valid value, false otherwise
+ */
+static bool parseValue(const string &cell, double &value) {
+    size_t length;
+    try {
+        value = stod(cell, &length);
+    } catch (const invalid_argument &) {
+        return false;
+    } catch (const out_of_range &) {
+        return false;
+    }
+    return length == cell.size() && isfinite(value) && value >= 0;
+}
+
+TimeProfile::TimeProfile() = default;
+
+void TimeProfile::clear() {
+    stepNames.clear();
+    codes.clear();
+    values.clear();
+}
+
+bool TimeProfile::load(const string &path) {
+    clear();
+    ifstream inputFile(path);
+    istringstream iss;
+    string line, cell;
+
+    if (!getline(inputFile, line))
+        return false;
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+    iss.str(line);
+    getline(iss, cell, ',');
+    while (getline(iss, cell, ','))
+        stepNames.push_back(cell);
+
+    while (getline(inputFile, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+        iss.clear();
+        iss.str(line);
+        getline(iss, cell, ',');
+        codes.push_back(cell);
+        values.emplace_back();
+        values.back().reserve(stepNames.size());
+        double value;
+        bool valid = true;
+        while (valid && getline(iss, cell, ',') && !cell.empty()) {
+            valid = parseValue(cell, value);
+            values.back().push_back(value);
+        }
+        if (!valid || codes.back().empty() || values.back().size() != stepNames.size()) {
+            clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t TimeProfile::getNumSteps() const {
+    return stepNames.size();
+}
+
+const string &TimeProfile::getStepName(size_t step) const {
+    return stepNames[step];
+}
+
+size_t TimeProfile::getNumRows() const {
+    return codes.size();
+}
+
+const string &TimeProfile::getCode(size_t row) const {
+    return codes[row];
+}
+
+double TimeProfile::getValue(size_t row, size_t step) const {
+    return values[row][step];
+}
@@ -3,22 +3,55 @@
 #include <sstream>
 #include "Reservoir.h"
 #include "PumpingStation.h"
+#include "StationOutlet.h"
 #include "DeliverySite.h"
 #include "Pipe.h"
-#include "AugmentingPath.h"
+#include "AugmentingPathPool.h"
+#include "FlowGraphReducer.h"
+#include "NetworkDecomposition.h"
 #include <iostream>
 #include <queue>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <unordered_map>
+
+/**
+ * @brief Residual capacity below which a pipe is considered saturated
+ */
+static const double FLOW_EPSILON = 1e-9;
+
+/**
+ * @brief Relative difference below which two values of max flows are considered equal (see getFlowTolerance)
+ */
+static const double FLOW_TOLERANCE = 1e-6;
+
+/**
+ * @brief Largest factor of the demands tried by getDemandBreakpoints
+ */
+static const double MAX_DEMAND_FACTOR = 1 << 30;
 
 using namespace std;
 
-WaterSupplyNetwork::WaterSupplyNetwork() : maxFlowNetwork(nullptr), superSource(nullptr), superSink(nullptr) {};
+/**
+ * @brief Hides a pipe together with its other direction in the dataset, which is its reverse or its twin
+ * @param pipe Pointer to the pipe
+ */
+static void hideBothDirections(Pipe *pipe) {
+    pipe->setHidden(true);
+    if (pipe->getReverse() != nullptr)
+        pipe->getReverse()->setHidden(true);
+    if (pipe->getTwin() != nullptr)
+        pipe->getTwin()->setHidden(true);
+}
+
+WaterSupplyNetwork::WaterSupplyNetwork() : maxFlowNetwork(nullptr), storedNetwork(nullptr), version(0),
+                                           topologyVersion(0), cachedVersion(0), storedTopologyVersion(0),
+                                           superSource(nullptr), superSink(nullptr), maxFlowThreads(0) {};
 
 WaterSupplyNetwork::~WaterSupplyNetwork() {
-    for (AugmentingPath *augmentingPath: augmentingPaths)
-        delete augmentingPath;
     delete maxFlowNetwork;
+    delete storedNetwork;
 }
 
 bool WaterSupplyNetwork::parseData(const string& reservoirPath, const string& stationsPath, const string& citiesPath, const string& pipesPath) {
@@ -39,6 +72,7 @@ bool WaterSupplyNetwork::parseData(const string& reservoirPath, const string& st
         return false;
     }
     createSuperSourceAndSuperSink(true);
+    freeze();
     return true;
 }
 
@@ -79,7 +113,7 @@ bool WaterSupplyNetwork::parseReservoir(const std::string& reservoirPath) {
 bool WaterSupplyNetwork::parseStations(const std::string& stationsPath) {
     ifstream inputFile(stationsPath);
     istringstream iss;
-    string line, id, code;
+    string line, id, code, cost, capacity;
 
     if(!getline(inputFile, line)) {
         return false;
@@ -89,13 +123,27 @@ bool WaterSupplyNetwork::parseStations(const std::string& stationsPath) {
         iss.clear();
         iss.str(line);
         getline(iss, id, ',');
-        getline(iss, code);
+        getline(iss, code, ',');
         trimString(code);
+        // Optional columns with the pumping cost and the throughput limit
+        cost.clear();
+        capacity.clear();
+        getline(iss, cost, ',');
+        trimString(cost);
+        getline(iss, capacity);
+        trimString(capacity);
         if (id.empty() || code.empty())
             break;
 
         auto pumpingStation = new PumpingStation(stoi(id), code);
+        if (!cost.empty())
+            pumpingStation->setPumpingCost(stod(cost));
         this->addVertex(pumpingStation);
+        if (!capacity.empty()) {
+            pumpingStation->setCapacity(stod(capacity));
+            addStationOutlet(pumpingStation);
+            addEdge(code, pumpingStation->getOutlet()->getCode(), stod(capacity));
+        }
     }
 
     return true;
@@ -143,7 +191,7 @@ bool WaterSupplyNetwork::parseCities(const std::string& citiesPath) {
 bool WaterSupplyNetwork::parsePipes(const std::string& pipesPath) {
     ifstream inputFile(pipesPath);
     istringstream iss;
-    string line, Service_Point_A, Service_Point_B, capacity, direction;
+    string line, Service_Point_A, Service_Point_B, capacity, direction, cost;
 
     if(!getline(inputFile, line)) {
         return false;
@@ -155,16 +203,41 @@ bool WaterSupplyNetwork::parsePipes(const std::string& pipesPath) {
         getline(iss, Service_Point_A, ',');
         getline(iss, Service_Point_B, ',');
         getline(iss, capacity, ',');
-        getline(iss, direction);
+        getline(iss, direction, ',');
         trimString(direction);
+        // Optional column with the cost per unit of flow
+        cost.clear();
+        getline(iss, cost);
+        trimString(cost);
 
         if (Service_Point_A.empty() || Service_Point_B.empty() || capacity.empty() || direction.empty())
             break;
 
-        if (direction[0] == '0')
+        // The pipes that leave a pumping station with a throughput limit leave from its outlet, so a bidirectional pipe
+        // of such a station becomes two pipes (the reverse of a pipe must connect the same service points), which are
+        // (twins, which fail and are hidden together like a pipe and its reverse)
+        string origin = getOutletCode(Service_Point_A), reverseOrigin = getOutletCode(Service_Point_B);
+        bool bidirectional = direction[0] == '0';
+        if (bidirectional && origin == Service_Point_A && reverseOrigin == Service_Point_B) {
             addBidirectionalEdge(Service_Point_A, Service_Point_B, stod(capacity));
-        else
-            addEdge(Service_Point_A, Service_Point_B, stod(capacity));
+        } else {
+            addEdge(origin, Service_Point_B, stod(capacity));
+            if (bidirectional) {
+                addEdge(reverseOrigin, Service_Point_A, stod(capacity));
+                Pipe *forward = findPipe(origin, Service_Point_B), *backward = findPipe(reverseOrigin, Service_Point_A);
+                forward->setTwin(backward);
+                backward->setTwin(forward);
+            }
+        }
+
+        Pipe *pipe = findPipe(Service_Point_A, Service_Point_B);
+        Pipe *reverse = bidirectional ? findPipe(Service_Point_B, Service_Point_A) : nullptr;
+        if (!cost.empty()) {
+            if (pipe != nullptr)
+                pipe->setCost(stod(cost));
+            if (reverse != nullptr)
+                reverse->setCost(stod(cost));
+        }
     }
 
     return true;
@@ -189,6 +262,14 @@ std::vector<ServicePoint *> WaterSupplyNetwork::getServicePoints() {
 template<class T>
 vector<T *> WaterSupplyNetwork::filterVerticesByType() {
     std::vector<T*> res;
+    if (!servicePoints.empty()) {
+        for (ServicePoint *sp: servicePoints) {
+            auto r = dynamic_cast<T*>(sp);
+            if (r != nullptr)
+                res.push_back(r);
+        }
+        return res;
+    }
     for (Vertex<string>* v: getVertexSet()) {
         auto r = dynamic_cast<T*>(v);
         if (r != nullptr)
@@ -221,59 +302,143 @@ Pipe *WaterSupplyNetwork::findPipe(const std::string &src, const std::string &de
         if (pipe->getDest()->getCode() == dest)
             return pipe;
     }
+    // The outgoing pipes of a pumping station with a throughput limit are in its outlet
+    auto station = dynamic_cast<PumpingStation*>(srcSp);
+    if (station != nullptr && station->getOutlet() != nullptr)
+        return findPipe(station->getOutlet()->getCode(), dest);
     return nullptr;
 }
 
-double WaterSupplyNetwork::getMaxFlow(bool saveAugmentingPaths) {
+string WaterSupplyNetwork::getOutletCode(const string &code) {
+    PumpingStation *station = findPumpingStation(code);
+    return station != nullptr && station->getOutlet() != nullptr ? station->getOutlet()->getCode() : code;
+}
+
+void WaterSupplyNetwork::addStationOutlet(PumpingStation *station) {
+    auto outlet = new StationOutlet(station);
+    addVertex(outlet);
+    station->setOutlet(outlet);
+}
+
+double WaterSupplyNetwork::getMaxFlow(bool saveAugmentingPaths, MaxFlowAlgorithm algorithm) {
     if (saveAugmentingPaths)
         augmentingPaths.clear();
-    for (ServicePoint *v: getServicePoints()) {
-        for (Pipe *p: v->getAdj()) {
-            p->setFlow(0);
-            if (saveAugmentingPaths)
-                p->getAugmentingPaths().clear();
-        }
+    for (Pipe *p: pipes)
+        p->updateFlow(0);
+
+    if (algorithm == MAX_FLOW_PUSH_RELABEL && !saveAugmentingPaths) {
+        gatherArcs();
+        // The components are solved independently, each on its reduced graph
+        decomposition.solve(flowGraph, arcFlows, arcBlocked, maxFlowThreads);
+        for (Pipe *pipe: pipes)
+            pipe->updateFlow(arcFlows[pipe->getIndex()]);
+        return superSink->getInflow();
     }
 
     edmondsKarp(superSource, superSink, saveAugmentingPaths);
-
-    double maxFlow = 0;
-    for (Pipe *p: superSink->getIncoming()) {
-        maxFlow += p->getFlow();
+    if (saveAugmentingPaths) {
+        augmentingPaths.normalize();
+        augmentingPaths.buildPipeIndex(pipes);
     }
 
-    return maxFlow;
+    return superSink->getInflow();
 }
 
 double WaterSupplyNetwork::loadCachedMaxFlow() {
     double maxFlow = 0;
-    if (maxFlowNetwork == nullptr) {
+    if (maxFlowNetwork == nullptr || cachedVersion < topologyVersion) {
         unhideAllServicePoints();
         unhideAllPipes();
         maxFlow = getMaxFlow(true);
-        maxFlowNetwork = new WaterSupplyNetwork();
+        // The solvers over the flow graph read its capacities, which may have changed since the last max flow
+        flowGraph.updateCapacities(pipes);
+        if (maxFlowNetwork == nullptr)
+            maxFlowNetwork = new WaterSupplyNetwork();
         copyGraph(this, maxFlowNetwork);
+        cachedVersion = version;
         return maxFlow;
     }
+    if (cachedVersion != version)
+        return updateCachedMaxFlow();
 
     copyFlows(maxFlowNetwork, this);
 
-    for (Pipe *p: superSink->getIncoming()) {
-        maxFlow += p->getFlow();
+    return superSink->getInflow();
+}
+
+double WaterSupplyNetwork::getMinCostMaxFlow(double &cost) {
+    // Brings the capacities of the flow graph up to date
+    loadCachedMaxFlow();
+
+    vector<double> costs(pipes.size());
+    for (Pipe *pipe: pipes) {
+        auto station = dynamic_cast<PumpingStation*>(pipe->getDest());
+        costs[pipe->getIndex()] = pipe->getCost() + (station != nullptr ? station->getPumpingCost() : 0);
     }
 
+    FlowGraphReducer reducer(flowGraph);
+    reducer.reduce(vector<char>(pipes.size(), false));
+    MinCostFlowSolver solver(reducer.getReducedGraph(), reducer.reduceCosts(costs));
+    double maxFlow = solver.solve();
+    vector<double> flows;
+    reducer.expandFlows(solver.getFlows(), flows);
+    for (Pipe *pipe: pipes)
+        pipe->updateFlow(flows[pipe->getIndex()]);
+    cost = solver.getCost();
     return maxFlow;
 }
 
-double WaterSupplyNetwork::recalculateMaxFlow() {
-    edmondsKarp(superSource, superSink, false);
+double WaterSupplyNetwork::updateCachedMaxFlow() {
+    unhideAllServicePoints();
+    unhideAllPipes();
+    copyFlows(maxFlowNetwork, this);
 
-    double maxFlow = 0;
-    for (Pipe *p: superSink->getIncoming()) {
-        maxFlow += p->getFlow();
+    unselectAllAugmentingPaths();
+    for (Pipe *pipe: pipes) {
+        if (pipe->getFlow() > pipe->getCapacity())
+            augmentingPaths.selectPipePaths(pipe->getIndex());
     }
+    subtractAugmentingPaths();
+    augmentingPaths.discardSelected();
 
-    return maxFlow;
+    edmondsKarp(superSource, superSink, true);
+    augmentingPaths.normalize();
+    augmentingPaths.buildPipeIndex(pipes);
+    flowGraph.updateCapacities(pipes);
+
+    for (size_t i = 0; i < pipes.size(); i++)
+        maxFlowNetwork->pipes[i]->setCapacity(pipes[i]->getCapacity());
+    copyFlows(this, maxFlowNetwork);
+    cachedVersion = version;
+
+    return superSink->getInflow();
+}
+
+void WaterSupplyNetwork::invalidateCachedMaxFlow() {
+    topologyVersion = ++version;
+}
+
+unsigned long WaterSupplyNetwork::getVersion() const {
+    return version;
+}
+
+void WaterSupplyNetwork::setPipeCapacity(Pipe *pipe, double capacity) {
+    // Both directions of a bidirectional pipe are the same pipe of the dataset, whether it was split or not
+    bool changed = false;
+    for (Pipe *direction: {pipe, pipe->getReverse(), pipe->getTwin()}) {
+        if (direction == nullptr || direction->getCapacity() == capacity)
+            continue;
+        direction->setCapacity(capacity);
+        changed = true;
+    }
+    if (changed)
+        version++;
+}
+
+double WaterSupplyNetwork::recalculateMaxFlow() {
+    edmondsKarp(superSource, superSink, false);
+
+    return superSink->getInflow();
 }
 
 void WaterSupplyNetwork::createSuperSourceAndSuperSink(bool createPipes) {
@@ -301,23 +466,22 @@ void WaterSupplyNetwork::edmondsKarp(ServicePoint *source, ServicePoint *sink, b
         if (!sink->isVisited())
             break;
 
-        AugmentingPath* augmentingPath = reduceAugmentingPath(source, sink);
-        if (savePaths) {
-            augmentingPaths.push_back(augmentingPath);
-            for (auto pair: augmentingPath->getPipes()) {
-                Pipe *pipe = pair.first;
-                pipe->getAugmentingPaths().push_back(augmentingPath);
-                if (pipe->getReverse() != nullptr)
-                    pipe->getReverse()->getAugmentingPaths().push_back(augmentingPath);
-            }
-        } else {
-            delete augmentingPath;
-        }
+        double capacity = reduceAugmentingPath(source, sink);
+        if (savePaths)
+            augmentingPaths.addPath(augmentingPathBuffer, capacity);
     }
 }
 
 void WaterSupplyNetwork::edmondsKarpBfs(ServicePoint *srcSp, ServicePoint *sinkSp) {
-    for (ServicePoint* sp: getServicePoints()) {
+    if (srcSp == superSource && sinkSp == superSink) {
+        ParallelBfs parallelBfs(flowGraph, maxFlowThreads);
+        if (prepareParallelBfs(parallelBfs)) {
+            parallelEdmondsKarpBfs(parallelBfs);
+            return;
+        }
+    }
+
+    for (ServicePoint* sp: servicePoints) {
         sp->setVisited(false);
         sp->setPath(nullptr);
     }
@@ -359,56 +523,164 @@ void WaterSupplyNetwork::edmondsKarpBfs(ServicePoint *srcSp, ServicePoint *sinkS
     }
 }
 
-AugmentingPath *WaterSupplyNetwork::reduceAugmentingPath(ServicePoint *source, ServicePoint *sink) {
+bool WaterSupplyNetwork::prepareParallelBfs(ParallelBfs &parallelBfs) {
+    if (!parallelBfs.isWorthIt())
+        return false;
+    // The threads of the searches are kept until the number of threads changes
+    if (bfsScheduler == nullptr)
+        bfsScheduler = make_shared<TaskScheduler>(maxFlowThreads);
+    parallelBfs.setScheduler(bfsScheduler);
+    return true;
+}
+
+void WaterSupplyNetwork::gatherArcs() {
+    // The capacities of the pipes may have changed since the last max flow
+    flowGraph.updateCapacities(pipes);
+    arcFlows.resize(pipes.size());
+    arcBlocked.resize(pipes.size());
+    for (Pipe *pipe: pipes) {
+        arcFlows[pipe->getIndex()] = pipe->getFlow();
+        arcBlocked[pipe->getIndex()] = pipe->isHidden() || pipe->getOrig()->isHidden() || pipe->getDest()->isHidden();
+    }
+}
+
+void WaterSupplyNetwork::parallelEdmondsKarpBfs(ParallelBfs &parallelBfs) {
+    gatherArcs();
+    bfsParentArcs.resize(servicePoints.size());
+    bfsParentDirect.resize(servicePoints.size());
+    parallelBfs.search(arcFlows, flowGraph.getCapacities(), arcBlocked, bfsParentArcs, bfsParentDirect);
+
+    for (ServicePoint *sp: servicePoints) {
+        bool reached = parallelBfs.isReached(sp->getIndex());
+        sp->setVisited(reached);
+        sp->setPath(reached && sp != superSource ? pipes[bfsParentArcs[sp->getIndex()]] : nullptr);
+    }
+}
+
+void WaterSupplyNetwork::setMaxFlowThreads(unsigned numThreads) {
+    maxFlowThreads = numThreads;
+    bfsScheduler.reset();
+}
+
+double WaterSupplyNetwork::reduceAugmentingPath(ServicePoint *source, ServicePoint *sink) {
     ServicePoint *sp = sink;
-    auto *augmentingPath = new AugmentingPath();
+    double capacity = numeric_limits<double>::infinity();
+    augmentingPathBuffer.clear();
 
     while (sp->getCode() != source->getCode()) {
         Pipe *path = sp->getPath();
         bool incoming = *sp == *path->getDest();
-        augmentingPath->addPipe(path, incoming);
+        capacity = min(capacity, incoming ? path->getRemainingFlow() : path->getFlow());
+        augmentingPathBuffer.emplace_back(path, incoming);
         sp = incoming ? path->getOrig() : path->getDest();
     }
 
-    for (auto pair: augmentingPath->getPipes()) {
-        Pipe *pipe = pair.first;
-        bool incoming = pair.second;
-        pipe->setFlow(incoming ? pipe->getFlow() + augmentingPath->getCapacity() : pipe->getFlow() - augmentingPath->getCapacity());
-        if (pipe->getReverse() != nullptr) {
-            pipe->getReverse()->setFlow(incoming ? pipe->getReverse()->getFlow() - augmentingPath->getCapacity() :
-                                        pipe->getReverse()->getFlow() + augmentingPath->getCapacity());
+    for (auto pair: augmentingPathBuffer)
+        addPipeFlow(pair.first, pair.second, capacity);
+
+    return capacity;
+}
+
+void WaterSupplyNetwork::addPipeFlow(Pipe *pipe, bool incoming, double value) {
+    pipe->updateFlow(incoming ? pipe->getFlow() + value : pipe->getFlow() - value);
+    if (pipe->getReverse() != nullptr)
+        pipe->getReverse()->updateFlow(incoming ? pipe->getReverse()->getFlow() - value : pipe->getReverse()->getFlow() + value);
+}
+
+void WaterSupplyNetwork::repairFlows(const vector<double> &flows) {
+    for (Pipe *pipe: pipes) {
+        Pipe *reverse = pipe->getReverse();
+        if (reverse != nullptr && reverse->getIndex() < pipe->getIndex())
+            continue;
+        // A hidden pipe cannot carry flow in its direction, but the reverse of a bidirectional pipe still can
+        bool spHidden = pipe->getOrig()->isHidden() || pipe->getDest()->isHidden();
+        double upper = spHidden || pipe->isHidden() ? 0 : pipe->getCapacity();
+        double lower = reverse == nullptr || spHidden || reverse->isHidden() ? 0 : -reverse->getCapacity();
+        double flow = max(min(flows[pipe->getIndex()], upper), lower);
+        pipe->updateFlow(flow);
+        if (reverse != nullptr)
+            reverse->updateFlow(-flow);
+    }
+
+    // Excess of each service point: the flow that enters it minus the flow that leaves it
+    vector<double> excesses(servicePoints.size(), 0);
+    for (Pipe *pipe: pipes) {
+        if (pipe->getReverse() != nullptr && pipe->getFlow() <= 0)
+            continue;
+        excesses[pipe->getDest()->getIndex()] += pipe->getFlow();
+        excesses[pipe->getOrig()->getIndex()] -= pipe->getFlow();
+    }
+
+    queue<ServicePoint*> spQueue;
+    for (ServicePoint *sp: servicePoints) {
+        if (sp != superSource && sp != superSink && excesses[sp->getIndex()] != 0)
+            spQueue.push(sp);
+    }
+    while (!spQueue.empty()) {
+        ServicePoint *sp = spQueue.front();
+        spQueue.pop();
+        double &excess = excesses[sp->getIndex()];
+
+        // Excess goes back through the pipes that bring flow, missing flow is removed from the pipes that take it
+        vector<Pipe*> candidates = excess > 0 ? sp->getIncoming() : sp->getAdj();
+        for (Pipe *pipe: candidates) {
+            if (excess == 0)
+                break;
+            if (pipe->getFlow() <= 0)
+                continue;
+            double value = min(fabs(excess), pipe->getFlow());
+            addPipeFlow(pipe, false, value);
+            ServicePoint *other = excess > 0 ? pipe->getOrig() : pipe->getDest();
+            double &otherExcess = excesses[other->getIndex()];
+            bool wasBalanced = otherExcess == 0;
+            otherExcess += excess > 0 ? value : -value;
+            excess += excess > 0 ? -value : value;
+            if (wasBalanced && other != superSource && other != superSink)
+                spQueue.push(other);
         }
     }
+}
 
-    return augmentingPath;
+double WaterSupplyNetwork::getMaxFlowFrom(const vector<double> &flows) {
+    repairFlows(flows);
+    edmondsKarp(superSource, superSink, false);
+    return superSink->getInflow();
+}
+
+vector<double> WaterSupplyNetwork::getPipeFlows() const {
+    vector<double> flows(pipes.size());
+    for (Pipe *pipe: pipes)
+        flows[pipe->getIndex()] = pipe->getFlow();
+    return flows;
 }
 
-void WaterSupplyNetwork::subtractAugmentingPath(const AugmentingPath *augmentingPath) {
-    for (auto pair: augmentingPath->getPipes()) {
-        Pipe *p = pair.first;
-        bool incoming = pair.second;
-        double flowToRemove = augmentingPath->getCapacity();
-        p->setFlow(incoming ? p->getFlow() - flowToRemove : p->getFlow() + flowToRemove);
+void WaterSupplyNetwork::subtractAugmentingPath(int path) {
+    double flowToRemove = augmentingPaths.getCapacity(path);
+    for (uint32_t arc = augmentingPaths.getPathBegin(path); arc < augmentingPaths.getPathEnd(path); arc++) {
+        Pipe *p = pipes[augmentingPaths.getArcPipe(arc)];
+        bool incoming = augmentingPaths.isArcDirect(arc);
+        p->updateFlow(incoming ? p->getFlow() - flowToRemove : p->getFlow() + flowToRemove);
         if (p->getReverse() != nullptr) {
-            p->getReverse()->setFlow(incoming ? p->getReverse()->getFlow() + flowToRemove :
+            p->getReverse()->updateFlow(incoming ? p->getReverse()->getFlow() + flowToRemove :
                                      p->getReverse()->getFlow() - flowToRemove);
+            if (p->getReverse()->getFlow() > p->getReverse()->getCapacity())
+                augmentingPaths.selectPipePaths(p->getIndex());
         } else if (p->getFlow() < 0) {
-            p->selectAugmentingPaths();
+            augmentingPaths.selectPipePaths(p->getIndex());
         }
+        if (p->getFlow() > p->getCapacity())
+            augmentingPaths.selectPipePaths(p->getIndex());
     }
 }
 
 void WaterSupplyNetwork::subtractAugmentingPaths() {
-    for (const AugmentingPath *augmentingPath: augmentingPaths) {
-        if (!augmentingPath->isSelected())
-            continue;
-        subtractAugmentingPath(augmentingPath);
-    }
+    // Paths selected while subtracting are appended to the selection, so they are also visited by this loop
+    for (int i = 0; i < augmentingPaths.getNumSelected(); i++)
+        subtractAugmentingPath(augmentingPaths.getSelected(i));
 }
 
 void WaterSupplyNetwork::unselectAllAugmentingPaths() {
-    for (AugmentingPath *augmentingPath: augmentingPaths)
-        augmentingPath->setSelected(false);
+    augmentingPaths.unselectAll();
 }
 
 void WaterSupplyNetwork::unhideAllServicePoints() {
@@ -455,10 +727,43 @@ void WaterSupplyNetwork::unhidePipe(Pipe *pipe) {
     pipe->setHidden(false);
 }
 
+void WaterSupplyNetwork::freeze() {
+    servicePoints.clear();
+    pipes.clear();
+    for (Vertex<string> *v: getVertexSet()) {
+        auto sp = dynamic_cast<ServicePoint*>(v);
+        if (sp != nullptr)
+            servicePoints.push_back(sp);
+    }
+    sort(servicePoints.begin(), servicePoints.end(), [](const ServicePoint *a, const ServicePoint *b) {
+        return a->getId() < b->getId() || (a->getId() == b->getId() && a->getCode() < b->getCode());
+    });
+
+    for (ServicePoint *sp: servicePoints)
+        sp->sortPipes();
+    for (size_t i = 0; i < servicePoints.size(); i++) {
+        ServicePoint *sp = servicePoints[i];
+        sp->setIndex((int)i);
+        for (Pipe *pipe: sp->getAdj()) {
+            pipe->setIndex((int)pipes.size());
+            pipes.push_back(pipe);
+        }
+    }
+    if (superSource != nullptr && superSink != nullptr) {
+        flowGraph.build(servicePoints, pipes, superSource, superSink);
+        decomposition.build(flowGraph);
+    }
+    topologyVersion = ++version;
+}
+
 void WaterSupplyNetwork::copyGraph(WaterSupplyNetwork *network1, WaterSupplyNetwork *network2) {
+    network2->servicePoints.clear();
+    network2->pipes.clear();
     VertexSet<string> vertexes2 = network2->getVertexSet();
     for (Vertex<string> *v: vertexes2)
         network2->removeVertex(v->getInfo());
+    network2->superSource = nullptr;
+    network2->superSink = nullptr;
 
     for (Reservoir *reservoir: network1->getReservoirs()) {
         auto *newReservoir = new Reservoir(reservoir->getName(), reservoir->getMunicipality(), reservoir->getId(), reservoir->getCode(), reservoir->getMaxDelivery());
@@ -466,7 +771,11 @@ void WaterSupplyNetwork::copyGraph(WaterSupplyNetwork *network1, WaterSupplyNetw
     }
     for (PumpingStation *pumpingStation: network1->getPumpingStations()) {
         auto *newPumpingStation = new PumpingStation(pumpingStation->getId(), pumpingStation->getCode());
+        newPumpingStation->setPumpingCost(pumpingStation->getPumpingCost());
+        newPumpingStation->setCapacity(pumpingStation->getCapacity());
         network2->addVertex(newPumpingStation);
+        if (pumpingStation->getOutlet() != nullptr)
+            network2->addStationOutlet(newPumpingStation);
     }
     for (DeliverySite *deliverySite: network1->getDeliverySites()) {
         auto *newDeliverySite = new DeliverySite(deliverySite->getCity(), deliverySite->getId(), deliverySite->getCode(), deliverySite->getDemand(), deliverySite->getPopulation());
@@ -481,33 +790,41 @@ void WaterSupplyNetwork::copyGraph(WaterSupplyNetwork *network1, WaterSupplyNetw
             } else if (pipe->getReverse() == nullptr) {
                 network2->addEdge(sp->getCode(), pipe->getDest()->getCode(), pipe->getCapacity());
             }
-            network2->findPipe(sp->getCode(), pipe->getDest()->getCode())->setFlow(pipe->getFlow());
+            Pipe *newPipe = network2->findPipe(sp->getCode(), pipe->getDest()->getCode());
+            newPipe->updateFlow(pipe->getFlow());
+            newPipe->setCost(pipe->getCost());
+        }
+    }
+    for (ServicePoint *sp: network1->getServicePoints()) {
+        for (Pipe *pipe: sp->getAdj()) {
+            if (pipe->getTwin() != nullptr)
+                network2->findPipe(sp->getCode(), pipe->getDest()->getCode())->setTwin(
+                        network2->findPipe(pipe->getTwin()->getOrig()->getCode(), pipe->getTwin()->getDest()->getCode()));
         }
     }
+    network2->freeze();
 }
 
 void WaterSupplyNetwork::copyFlows(WaterSupplyNetwork *network1, WaterSupplyNetwork *network2) {
-    for (ServicePoint *sp1: network1->getServicePoints()) {
-        for (Pipe *pipe1: sp1->getAdj()) {
-            Pipe *pipe2 = network2->findPipe(pipe1->getOrig()->getCode(), pipe1->getDest()->getCode());
-            pipe2->setFlow(pipe1->getFlow());
-        }
-    }
+    for (size_t i = 0; i < network1->pipes.size(); i++)
+        network2->pipes[i]->updateFlow(network1->pipes[i]->getFlow());
 }
 
 void WaterSupplyNetwork::storeNetwork() {
-    if (maxFlowNetwork == nullptr) {
-        maxFlowNetwork = new WaterSupplyNetwork();
-        copyGraph(this, maxFlowNetwork);
+    if (storedNetwork == nullptr || storedTopologyVersion != topologyVersion) {
+        if (storedNetwork == nullptr)
+            storedNetwork = new WaterSupplyNetwork();
+        copyGraph(this, storedNetwork);
+        storedTopologyVersion = topologyVersion;
     } else {
-        copyFlows(this, maxFlowNetwork);
+        copyFlows(this, storedNetwork);
     }
 }
 
 void WaterSupplyNetwork::loadNetwork() {
-    if (maxFlowNetwork == nullptr)
+    if (storedNetwork == nullptr || storedTopologyVersion != topologyVersion)
         return;
-    copyFlows(maxFlowNetwork, this);
+    copyFlows(storedNetwork, this);
 }
 
 double WaterSupplyNetwork::getMaxFlowWithoutPipes(const std::vector<Pipe *> &pipes) {
@@ -515,10 +832,10 @@ double WaterSupplyNetwork::getMaxFlowWithoutPipes(const std::vector<Pipe *> &pip
     unselectAllAugmentingPaths();
 
     for (Pipe *pipe: pipes) {
-        pipe->selectAugmentingPaths();
-        pipe->setHidden(true);
-        if (pipe->getReverse() != nullptr)
-            pipe->getReverse()->setHidden(true);
+        augmentingPaths.selectPipePaths(pipe->getIndex());
+        if (pipe->getTwin() != nullptr)
+            augmentingPaths.selectPipePaths(pipe->getTwin()->getIndex());
+        hideBothDirections(pipe);
     }
 
     subtractAugmentingPaths();
@@ -535,12 +852,8 @@ double WaterSupplyNetwork::getMaxFlowWithoutStation(PumpingStation *station) {
 
 double WaterSupplyNetwork::getMaxFlowWithoutPipesBF(const std::vector<Pipe *> &pipes) {
     unhideAllPipes();
-    for (auto p : pipes){
-        p->setHidden(true);
-        if (p->getReverse() != nullptr){
-            p->getReverse()->setHidden(true);
-        }
-    }
+    for (auto p : pipes)
+        hideBothDirections(p);
     return getMaxFlow();
 }
 
@@ -556,144 +869,447 @@ double WaterSupplyNetwork::getMaxFlowWithoutStationBF(PumpingStation* station) {
     return getMaxFlow();
 }
 
-std::vector<Pipe *> WaterSupplyNetwork::getCriticalPipesToCity(DeliverySite *city) {
+double WaterSupplyNetwork::getMaxFlowWithoutPipesInComponents(const vector<Pipe *> &pipes) {
+    unhideAllPipes();
+    double maxFlow = loadCachedMaxFlow();
+
+    vector<int> components;
+    for (Pipe *pipe: pipes) {
+        hideBothDirections(pipe);
+        for (Pipe *direction: {pipe, pipe->getTwin()}) {
+            int component = direction != nullptr ? decomposition.getArcComponent(direction->getIndex()) : -1;
+            if (component != -1 && find(components.begin(), components.end(), component) == components.end())
+                components.push_back(component);
+        }
+    }
+    if (components.empty())
+        return maxFlow;
+
+    gatherArcs();
+    for (int component: components)
+        maxFlow -= decomposition.getComponentFlow(flowGraph, arcFlows, component);
+    maxFlow += decomposition.solveComponents(flowGraph, components, arcFlows, arcBlocked, maxFlowThreads);
+    for (int component: components) {
+        for (int arc: decomposition.getComponentArcs(component))
+            this->pipes[arc]->updateFlow(arcFlows[arc]);
+    }
+    return maxFlow;
+}
+
+int WaterSupplyNetwork::getNumComponents() const {
+    return decomposition.getNumComponents();
+}
+
+int WaterSupplyNetwork::getComponent(const ServicePoint *servicePoint) const {
+    return decomposition.getComponent(servicePoint->getIndex());
+}
+
+vector<double> WaterSupplyNetwork::getComponentFlows() {
+    loadCachedMaxFlow();
+    vector<double> flows = getPipeFlows(), componentFlows;
+    for (int component = 0; component < decomposition.getNumComponents(); component++)
+        componentFlows.push_back(decomposition.getComponentFlow(flowGraph, flows, component));
+    return componentFlows;
+}
+
+vector<ServicePoint *> WaterSupplyNetwork::getArticulationPoints() const {
+    vector<ServicePoint*> res;
+    for (ServicePoint *sp: servicePoints) {
+        if (sp == superSource || sp == superSink || !decomposition.isArticulationPoint(sp->getIndex()))
+            continue;
+        auto outlet = dynamic_cast<StationOutlet*>(sp);
+        ServicePoint *point = outlet != nullptr ? outlet->getStation() : sp;
+        if (find(res.begin(), res.end(), point) == res.end())
+            res.push_back(point);
+    }
+    return res;
+}
+
+vector<Pipe *> WaterSupplyNetwork::getBridgePipes() const {
+    vector<Pipe*> res;
+    for (Pipe *pipe: pipes) {
+        if (!decomposition.isBridge(pipe->getIndex()) || dynamic_cast<StationOutlet*>(pipe->getDest()) != nullptr
+            || (pipe->getReverse() != nullptr && pipe->getReverse()->getIndex() < pipe->getIndex()))
+            continue;
+        res.push_back(pipe);
+    }
+    return res;
+}
+
+std::vector<Pipe *> WaterSupplyNetwork::getCriticalPipesToCity(DeliverySite *city, unsigned numThreads) {
     loadCachedMaxFlow();
     unselectAllAugmentingPaths();
 
     std::vector<Pipe *> possiblePipes, res;
 
-    for (ServicePoint *sp: getServicePoints()) {
-        for (Pipe *pipe: sp->getAdj()) {
-            pipe->setSelected(false);
-        }
-    }
+    for (Pipe *pipe: pipes)
+        pipe->setSelected(false);
     for (Pipe *pipe: city->getIncoming()) {
-        for (AugmentingPath *path: pipe->getAugmentingPaths()) {
-            for (auto pair: path->getPipes()) {
-                Pipe* p = pair.first;
-                p->setSelected(true);
-            }
+        for (auto it = augmentingPaths.getPipePathsBegin(pipe->getIndex()); it != augmentingPaths.getPipePathsEnd(pipe->getIndex()); it++) {
+            for (uint32_t arc = augmentingPaths.getPathBegin(*it); arc < augmentingPaths.getPathEnd(*it); arc++)
+                this->pipes[augmentingPaths.getArcPipe(arc)]->setSelected(true);
         }
     }
-    for (ServicePoint *sp: getServicePoints()) {
-        for (Pipe *pipe: sp->getAdj()) {
-            if (!pipe->isSelected() || *pipe->getOrig() == *superSource || *pipe->getDest() == *superSink)
-                continue;
-            possiblePipes.push_back(pipe);
+    for (Pipe *pipe: pipes) {
+        if (!pipe->isSelected() || pipe->getOrig() == superSource || pipe->getDest() == superSink)
+            continue;
+        // The twins of a split pipe fail together, so only the first one with paths is a candidate
+        if (pipe->getTwin() != nullptr && pipe->getTwin()->isSelected() && pipe->getTwin()->getIndex() < pipe->getIndex())
+            continue;
+        possiblePipes.push_back(pipe);
+    }
+
+    // A bridge that cuts a supplied city off from every reservoir is critical, since no repair can bring water back to
+    // it. Only the other candidates need the failure engine
+    vector<double> baselineFlows = getPipeFlows();
+    vector<char> critical(possiblePipes.size(), false);
+    vector<size_t> uncertain;
+    for (size_t i = 0; i < possiblePipes.size(); i++) {
+        if (city->getSupplyRate() > FLOW_EPSILON
+            && decomposition.separatesFromSource(possiblePipes[i]->getIndex(), city->getIndex()))
+            critical[i] = true;
+        else
+            uncertain.push_back(i);
+    }
+
+    // Each uncertain candidate is repaired on its own by the failure engine, whose workers balance the uneven repairs
+    if (!uncertain.empty()) {
+        FailureScenarioEngine engine(flowGraph, baselineFlows, augmentingPaths);
+        for (size_t i: uncertain) {
+            Pipe *pipe = possiblePipes[i];
+            engine.addElement(getPipeDescription(pipe), {pipe->getIndex()});
         }
+
+        ScenarioResultStore store;
+        store.setCities({city});
+        store.setBaseline({city->getSupplyRate()});
+        engine.sweep({city->getIndex()}, store, numThreads);
+        for (size_t j = 0; j < uncertain.size(); j++)
+            critical[uncertain[j]] = store.getSupply(j, 0) < city->getSupplyRate() - FLOW_EPSILON;
     }
 
-    for (Pipe *pipe: possiblePipes) {
-        loadNetwork();
-        unselectAllAugmentingPaths();
-        pipe->selectAugmentingPaths();
-        subtractAugmentingPaths();
-        pipe->setHidden(true);
-        if (pipe->getReverse() != nullptr)
-            pipe->setHidden(true);
-        recalculateMaxFlow();
-        pipe->setHidden(false);
-        if (pipe->getReverse() != nullptr)
-            pipe->setHidden(false);
-        if (city->getSupplyRate() < maxFlowNetwork->findDeliverySite(city->getCode())->getSupplyRate())
-            res.push_back(pipe);
+    for (size_t i = 0; i < possiblePipes.size(); i++) {
+        if (critical[i])
+            res.push_back(possiblePipes[i]);
     }
     return res;
 }
 
-void compute_metrics(const vector<double> &v, tuple<double, double, double> &metrics) {
-    metrics = {0,0,0};
+FailureReport WaterSupplyNetwork::getWorstFailures(int k, unsigned numThreads) {
+    loadCachedMaxFlow();
+    vector<double> baselineFlows = getPipeFlows();
+
+    FailureScenarioEngine engine(flowGraph, baselineFlows, augmentingPaths);
+    addFailureElements(engine);
+
+    vector<DeliverySite*> cities = getDeliverySites();
+    vector<int> cityVertices;
+    for (DeliverySite *city: cities)
+        cityVertices.push_back(city->getIndex());
+
+    FailureReport report = engine.analyse(k, cityVertices, numThreads);
+    for (size_t i = 0; i < cities.size(); i++)
+        report.cities[i].city = cities[i];
+    return report;
+}
+
+void WaterSupplyNetwork::sweepFailures(ScenarioResultStore &store, unsigned numThreads) {
+    loadCachedMaxFlow();
+    vector<double> baselineFlows = getPipeFlows();
+
+    FailureScenarioEngine engine(flowGraph, baselineFlows, augmentingPaths);
+    addFailureElements(engine);
+    sweepEngine(engine, store, numThreads);
+}
 
-    // Compute max and mean
-    for (double value: v) {
-        get<1>(metrics) += value;
-        if(value > get<0>(metrics)) get<0>(metrics) = value;
+void WaterSupplyNetwork::sweepReservoirOutages(ScenarioResultStore &store, double capacityFactor, unsigned numThreads) {
+    loadCachedMaxFlow();
+    vector<double> baselineFlows = getPipeFlows();
+
+    // Only the pipe from the supersource is limited, so the other pipes of the reservoir can still carry water
+    FailureScenarioEngine engine(flowGraph, baselineFlows, augmentingPaths);
+    for (Pipe *pipe: superSource->getAdj())
+        engine.addElement(pipe->getDest()->getCode(), {pipe->getIndex()}, capacityFactor);
+    sweepEngine(engine, store, numThreads);
+}
+
+void WaterSupplyNetwork::sweepStationDegradations(ScenarioResultStore &store, double capacityFactor, unsigned numThreads) {
+    loadCachedMaxFlow();
+    vector<double> baselineFlows = getPipeFlows();
+
+    // The outgoing pipe of a station with a throughput limit is the one to its outlet
+    FailureScenarioEngine engine(flowGraph, baselineFlows, augmentingPaths);
+    for (PumpingStation *station: getPumpingStations()) {
+        vector<int> arcs;
+        for (Pipe *pipe: station->getAdj())
+            arcs.push_back(pipe->getIndex());
+        engine.addElement(station->getCode(), arcs, capacityFactor);
     }
-    get<1>(metrics) /= (double)v.size();
+    sweepEngine(engine, store, numThreads);
+}
 
-    // Compute variance
-    for(double value: v) {
-        get<2>(metrics) += (value - get<1>(metrics)) * (value - get<1>(metrics));
+void WaterSupplyNetwork::sweepEngine(const FailureScenarioEngine &engine, ScenarioResultStore &store, unsigned numThreads) {
+    vector<DeliverySite*> cities = getDeliverySites();
+    store.setCities(cities);
+    vector<int> cityVertices(cities.size());
+    vector<double> baselineSupplies(cities.size());
+    for (DeliverySite *city: cities) {
+        int column = store.getColumn(city->getId());
+        cityVertices[column] = city->getIndex();
+        baselineSupplies[column] = city->getSupplyRate();
     }
-    get<2>(metrics) /= (double)v.size();
+    store.setBaseline(baselineSupplies);
+    engine.sweep(cityVertices, store, numThreads);
 }
 
-void WaterSupplyNetwork::getMetrics(tuple<double, double, double> &metrics){
-    vector<double> differences;
+vector<char> WaterSupplyNetwork::findSinkReachable() {
+    vector<char> reachable(servicePoints.size(), false);
+    ParallelBfs parallelBfs(flowGraph, maxFlowThreads);
+    if (prepareParallelBfs(parallelBfs)) {
+        gatherArcs();
+        parallelBfs.searchToSink(arcFlows, flowGraph.getCapacities(), arcBlocked, FLOW_EPSILON);
+        for (ServicePoint *sp: servicePoints)
+            reachable[sp->getIndex()] = parallelBfs.isReached(sp->getIndex());
+        return reachable;
+    }
 
-    unhideAllPipes();
+    queue<ServicePoint*> spQueue;
+    reachable[superSink->getIndex()] = true;
+    spQueue.push(superSink);
+    while (!spQueue.empty()) {
+        ServicePoint *sp = spQueue.front();
+        spQueue.pop();
+        for (Pipe *pipe: sp->getIncoming()) {
+            auto other = static_cast<ServicePoint*>(pipe->getOrig());
+            if (pipe->isHidden() || other->isHidden() || reachable[other->getIndex()] || pipe->getRemainingFlow() <= FLOW_EPSILON)
+                continue;
+            reachable[other->getIndex()] = true;
+            spQueue.push(other);
+        }
+        for (Pipe *pipe: sp->getAdj()) {
+            auto other = static_cast<ServicePoint*>(pipe->getDest());
+            if (pipe->isHidden() || other->isHidden() || reachable[other->getIndex()] || pipe->getFlow() <= FLOW_EPSILON)
+                continue;
+            reachable[other->getIndex()] = true;
+            spQueue.push(other);
+        }
+    }
+    return reachable;
+}
 
-    for(ServicePoint *v: getServicePoints()) {
-        for(Pipe *p: v->getAdj()) {
-            // Hide Super-source or Super-sink
-            if (p->getDest()->getId() == 0 || p->getOrig()->getId() == 0) {p->setHidden(true); continue;}
-            // Hide negative flows
-            if (p->getFlow() < 0) {p->setHidden(true); continue;}
-
-            // Hide 0 flow bidirectional
-            if (p->getReverse() != nullptr){
-                if (p->getReverse()->getFlow() == 0 && p->getFlow() == 0){
-                    if (p->getReverse()->isHidden() && !p->isHidden()) continue;
-                    if (!p->getReverse()->isHidden() && p->isHidden()) continue;
-                    p->setHidden(true);
-                }
-            }
+vector<pair<DeliverySite*, double>> WaterSupplyNetwork::getDemandBreakpoints(double tolerance) {
+    loadCachedMaxFlow();
+    vector<DeliverySite*> cities = getDeliverySites();
+    vector<Pipe*> demandPipes(cities.size(), nullptr);
+    for (size_t i = 0; i < cities.size(); i++) {
+        for (Pipe *pipe: cities[i]->getAdj()) {
+            if (*pipe->getDest() == *superSink)
+                demandPipes[i] = pipe;
         }
     }
 
-    for (ServicePoint *v: getServicePoints()) {
-        for (Pipe *p: v->getAdj()) {
-            if(p->isHidden()) continue;
-            differences.push_back(p->getCapacity() - p->getFlow());
+    // Sets the demands to a factor and finds which cities are sure to be fully supplied
+    auto evaluate = [&](double factor, const vector<double> &startFlows, vector<double> &flows, vector<char> &supplied) {
+        for (size_t i = 0; i < cities.size(); i++)
+            setPipeCapacity(demandPipes[i], cities[i]->getDemand() * factor);
+        getMaxFlowFrom(startFlows);
+        flows = getPipeFlows();
+        vector<char> reachable = findSinkReachable();
+        supplied.resize(cities.size());
+        for (size_t i = 0; i < cities.size(); i++)
+            supplied[i] = !reachable[cities[i]->getIndex()];
+    };
+
+    // Each interval holds the cities that are fully supplied at its start and not at its end
+    struct Interval {
+        double low, high;
+        vector<double> lowFlows;
+        vector<int> cities;
+    };
+    vector<pair<DeliverySite*, double>> breakpoints;
+    vector<Interval> intervals;
+    vector<int> pending;
+    for (size_t i = 0; i < cities.size(); i++) {
+        if (cities[i]->getDemand() > 0)
+            pending.push_back((int)i);
+        else
+            breakpoints.emplace_back(cities[i], numeric_limits<double>::infinity());
+    }
+
+    vector<double> lowFlows(pipes.size(), 0), flows;
+    vector<char> supplied;
+    for (double low = 0, high = 1; !pending.empty(); low = high, high *= 2) {
+        if (high > MAX_DEMAND_FACTOR) {
+            for (int i: pending)
+                breakpoints.emplace_back(cities[i], numeric_limits<double>::infinity());
+            break;
         }
+        evaluate(high, lowFlows, flows, supplied);
+        Interval interval{low, high, lowFlows, {}};
+        vector<int> stillSupplied;
+        for (int i: pending)
+            (supplied[i] ? stillSupplied : interval.cities).push_back(i);
+        if (!interval.cities.empty())
+            intervals.push_back(interval);
+        pending.swap(stillSupplied);
+        lowFlows.swap(flows);
     }
 
-    compute_metrics(differences, metrics);
+    while (!intervals.empty()) {
+        Interval interval = intervals.back();
+        intervals.pop_back();
+        if (interval.high - interval.low <= tolerance * interval.high) {
+            for (int i: interval.cities)
+                breakpoints.emplace_back(cities[i], interval.low);
+            continue;
+        }
+        double middle = (interval.low + interval.high) / 2;
+        evaluate(middle, interval.lowFlows, flows, supplied);
+        Interval lower{interval.low, middle, interval.lowFlows, {}}, upper{middle, interval.high, flows, {}};
+        for (int i: interval.cities)
+            (supplied[i] ? upper : lower).cities.push_back(i);
+        if (!lower.cities.empty())
+            intervals.push_back(lower);
+        if (!upper.cities.empty())
+            intervals.push_back(upper);
+    }
 
-    unhideAllPipes();
+    for (size_t i = 0; i < cities.size(); i++)
+        setPipeCapacity(demandPipes[i], cities[i]->getDemand());
+    loadCachedMaxFlow();
+    sort(breakpoints.begin(), breakpoints.end(), [](const pair<DeliverySite*, double> &a,
+                                                    const pair<DeliverySite*, double> &b) {
+        return a.second < b.second || (a.second == b.second && a.first->getId() < b.first->getId());
+    });
+    return breakpoints;
 }
 
-void WaterSupplyNetwork::balance(double value) {
-    WaterSupplyNetwork auxNetwork;
-    double initFlow = getMaxFlow();
-    copyGraph(this, &auxNetwork);
-    bool found = true;
-    while (found) {
-        found = false;
-        copyFlows(this, &auxNetwork);
-        vector<Pipe *> pipes;
-
-        for(ServicePoint *sp: getServicePoints()) {
-            for (Pipe *p: sp->getAdj()) {
-                if(p->getFlow() > 0 && p->getCapacity() > 0 && p->getRemainingFlow() <= value && !(*p->getOrig() == *superSource) && !(*p->getDest() == *superSink))
-                    pipes.push_back(p);
-            }
-        }
-        if (pipes.empty())
-            break;
+bool WaterSupplyNetwork::simulateTimeSeries(const TimeProfile &profile, ScenarioResultStore &store) {
+    unordered_map<string, Pipe*> profilePipes;
+    for (Pipe *pipe: superSource->getAdj())
+        profilePipes[pipe->getDest()->getCode()] = pipe;
+    for (Pipe *pipe: superSink->getIncoming())
+        profilePipes[pipe->getOrig()->getCode()] = pipe;
+    vector<Pipe*> rowPipes(profile.getNumRows());
+    vector<double> staticCapacities(profile.getNumRows());
+    for (size_t row = 0; row < profile.getNumRows(); row++) {
+        auto it = profilePipes.find(profile.getCode(row));
+        if (it == profilePipes.end())
+            return false;
+        rowPipes[row] = it->second;
+        staticCapacities[row] = it->second->getCapacity();
+    }
 
-        sort(pipes.begin(), pipes.end(), [&](Pipe *a, Pipe *b){ return (a->getRemainingFlow() < b->getRemainingFlow() || (a->getRemainingFlow() == b->getRemainingFlow() && a->getCapacity() > b->getCapacity())); });
+    loadCachedMaxFlow();
+    vector<DeliverySite*> cities = getDeliverySites();
+    store.setCities(cities);
+    vector<DeliverySite*> columnCities(cities.size());
+    vector<double> supplies(cities.size());
+    for (DeliverySite *city: cities) {
+        int column = store.getColumn(city->getId());
+        columnCities[column] = city;
+        supplies[column] = city->getSupplyRate();
+    }
+    store.setBaseline(supplies);
+
+    for (size_t step = 0; step < profile.getNumSteps(); step++) {
+        for (size_t row = 0; row < profile.getNumRows(); row++)
+            setPipeCapacity(rowPipes[row], profile.getValue(row, step));
+        loadCachedMaxFlow();
+        for (size_t column = 0; column < columnCities.size(); column++)
+            supplies[column] = columnCities[column]->getSupplyRate();
+        store.appendScenario(profile.getStepName(step), supplies);
+    }
 
-        for (Pipe *targetPipe: pipes) {
-            double originalCapacity = targetPipe->getCapacity();
-            targetPipe->setCapacity(max(originalCapacity - floor(value), 0.0));
-            if (targetPipe->getReverse() != nullptr)
-                targetPipe->setCapacity(max(originalCapacity - floor(value), 0.0));
-            double finalFlow = getMaxFlow(false);
+    for (size_t row = 0; row < profile.getNumRows(); row++)
+        setPipeCapacity(rowPipes[row], staticCapacities[row]);
+    loadCachedMaxFlow();
+    return true;
+}
 
-            if (finalFlow < initFlow) {
-                copyFlows(&auxNetwork, this);
-                targetPipe->setCapacity(originalCapacity);
-            } else {
-                found = true;
-                break;
-            }
-        }
+void WaterSupplyNetwork::forEachFailureElement(const function<void(Pipe*)> &pipeFunction,
+                                               const function<void(Reservoir*)> &reservoirFunction,
+                                               const function<void(PumpingStation*)> &stationFunction) const {
+    for (Pipe *pipe: pipes) {
+        // The supersource and the supersink are the only service points with id 0, and the pipe into the outlet of a
+        // pumping station is part of the station
+        if (pipe->getOrig()->getId() == 0 || pipe->getDest()->getId() == 0
+            || dynamic_cast<StationOutlet*>(pipe->getDest()) != nullptr)
+            continue;
+        if ((pipe->getReverse() != nullptr && pipe->getReverse()->getIndex() < pipe->getIndex())
+            || (pipe->getTwin() != nullptr && pipe->getTwin()->getIndex() < pipe->getIndex()))
+            continue;
+        pipeFunction(pipe);
     }
+    for (ServicePoint *sp: servicePoints) {
+        if (auto reservoir = dynamic_cast<Reservoir*>(sp))
+            reservoirFunction(reservoir);
+        else if (auto station = dynamic_cast<PumpingStation*>(sp))
+            stationFunction(station);
+    }
+}
 
-    for (ServicePoint *sp: auxNetwork.getServicePoints()) {
-        for (Pipe *pipe: sp->getAdj()) {
-            findPipe(sp->getCode(), pipe->getDest()->getCode())->setCapacity(pipe->getCapacity());
-        }
+string WaterSupplyNetwork::getPipeDescription(const Pipe *pipe) {
+    string arrow = pipe->isBidirectional() ? "<->" : "->";
+    return pipe->getOrig()->getCode() + arrow + pipe->getDest()->getCode();
+}
+
+double WaterSupplyNetwork::getFlowTolerance(double flow) {
+    return FLOW_TOLERANCE * max(1.0, fabs(flow));
+}
+
+void WaterSupplyNetwork::addFailureElements(FailureScenarioEngine &engine) {
+    // A reservoir or a pumping station fails with every pipe into it and out of it
+    auto addServicePoint = [&](ServicePoint *sp) {
+        vector<int> arcs;
+        for (Pipe *pipe: sp->getAdj())
+            arcs.push_back(pipe->getIndex());
+        for (Pipe *pipe: sp->getIncoming())
+            arcs.push_back(pipe->getIndex());
+        engine.addElement(sp->getCode(), arcs);
+    };
+    forEachFailureElement([&](Pipe *pipe) { engine.addElement(getPipeDescription(pipe), {pipe->getIndex()}); },
+                          addServicePoint, addServicePoint);
+}
+
+void WaterSupplyNetwork::accumulateMetrics(MetricsAccumulator &accumulator) const {
+    accumulator.reset(pipes.size());
+    for (Pipe *pipe: pipes) {
+        // Skip the pipes of the super source and super sink, the pipes inside pumping stations, and the direction of each
+        // bidirectional pipe that is not used (the one with negative flow, or the last one if there is no flow)
+        if (pipe->getOrig()->getId() == 0 || pipe->getDest()->getId() == 0 || pipe->getFlow() < 0
+            || dynamic_cast<StationOutlet*>(pipe->getDest()) != nullptr)
+            continue;
+        Pipe *reverse = pipe->getReverse();
+        if (reverse != nullptr && pipe->getFlow() == 0 && reverse->getFlow() == 0 && reverse->getIndex() < pipe->getIndex())
+            continue;
+        accumulator.set(pipe->getIndex(), pipe->getCapacity() - pipe->getFlow());
+    }
+}
+
+void WaterSupplyNetwork::getMetrics(tuple<double, double, double> &metrics) const {
+    MetricsAccumulator accumulator;
+    accumulateMetrics(accumulator);
+    metrics = accumulator.getMetrics();
+}
+
+BalanceProgress WaterSupplyNetwork::balance(double timeBudget,
+                                            const function<void(const BalanceProgress &)> &progressCallback) {
+    loadCachedMaxFlow();
+    vector<double> flows(pipes.size());
+    vector<char> outletPipes(pipes.size(), false);
+    for (Pipe *pipe: pipes) {
+        flows[pipe->getIndex()] = pipe->getFlow();
+        outletPipes[pipe->getIndex()] = dynamic_cast<StationOutlet*>(pipe->getDest()) != nullptr;
     }
+
+    // The pipes inside the pumping stations are left out, like in accumulateMetrics
+    BalancingEngine engine(flowGraph, flows, outletPipes);
+    engine.setTimeBudget(timeBudget);
+    engine.setProgressCallback(progressCallback);
+    BalanceProgress result = engine.run();
+
+    for (Pipe *pipe: pipes)
+        pipe->updateFlow(flows[pipe->getIndex()]);
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "SolverVerifier.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * @brief Seed of the random networks, fixed so every run verifies the same networks
+ */
+static const unsigned long SEED = 2024;
+
+/**
+ * @brief Number of random networks verified, when the large network is not requested
+ */
+static const unsigned NUM_NETWORKS = 100;
+
+/**
+ * @brief Verifies the solvers on the random networks, or on the large network with the argument "--large"
+ * @details The files of the networks with a failed check are kept in the temporary directory.
+ * @return 0 if every check holds, 1 otherwise
+ */
+int main(int argc, char *argv[]) {
+    bool large = argc > 1 && strcmp(argv[1], "--large") == 0;
+    SolverVerifier verifier(SEED);
+    VerificationReport report = large ? verifier.runLarge() : verifier.run(NUM_NETWORKS);
+    cout << report.numNetworks << " networks, " << report.numChecks << " checks, " << report.failures.size()
+         << " failures" << endl;
+    for (const VerificationFailure &failure: report.failures)
+        cout << failure.prefix << ": " << failure.check << ": " << failure.detail << endl;
+    return report.failures.empty() ? 0 : 1;
+}